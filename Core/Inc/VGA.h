@@ -11,38 +11,116 @@
 #include <string.h>
 #include "main.h"
 #include "usb_frame_buffer.h"
+#include "framebuffer.h"
+#include "textmode.h"
+#include "tilemap.h"
+#include "VGA_SPI.h"
 
-extern DMA_HandleTypeDef hdma_tim1_up;
+extern DMA_HandleTypeDef hdma_tim1_ch1;
 extern TIM_HandleTypeDef htim3;
 extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim1;
 
-#define HVISIBLE 640
-#define HFPORCH 16
-#define HSYNC 96
-#define HBPORCH 48
-#define WHOLELINE 800
+#define VRES 120 //source rows, every mode scales these to its visible height
+#define HRES 160 //source pixels per row, one DMA byte each
 
-#define VVISIBLE 480
-#define VFPORCH 10
-#define VSYNC 2
-#define VBPORCH 34 //should be 33, but 34 works better
-#define WHOLEFRAME 525
+#define LINE_BYTES (HRES + 4) //DMA bytes per scanline: visible pixels plus a black word that holds GPIOB low and keeps both halves word aligned
+#if LINE_BYTES % 4
+#error "LINE_BYTES must be a multiple of 4: lineBuffer[1] is written with word stores"
+#endif
+#define RINGBUFFER_LINES 16
 
-#define UPSCALE 4
+// Timing for one monitor mode. Horizontal values are in dots of TIM2, which
+// runs at 72MHz / hdiv. HSYNC starts at dot 0 and VSYNC at line 0, visible
+// pixels and lines follow the back porch.
+typedef struct {
+	const char *name;
+	uint8_t hdiv;                     // TIM2 prescaler
+	uint16_t hvisible;
+	uint16_t hfporch;
+	uint16_t hsync;
+	uint16_t hbporch;
+	uint16_t hwhole;                  // TIM2 period
+	uint16_t vvisible;
+	uint16_t vfporch;
+	uint16_t vsync;
+	uint16_t vbporch;
+	uint16_t vwhole;                  // TIM3 period
+	uint8_t hsync_positive;
+	uint8_t vsync_positive;
+	uint8_t dma_div;                  // TIM1 period, 72MHz cycles per DMA byte
+	uint8_t upscale;                  // scanlines per source row
+} VGA_Mode;
 
-#define VRES (VVISIBLE / UPSCALE) //120
-#define HRES (HVISIBLE / UPSCALE) //160
-#define HRESFULL (WHOLELINE / UPSCALE)
+typedef enum {
+	VGA_MODE_640x480_60,
+	VGA_MODE_640x400_70,
+	VGA_MODE_720x400_70,
+	VGA_MODE_800x600_56,
+	VGA_MODE_COUNT
+} VGA_ModeId;
 
-#define OFFSET 9 //horizontal offset for image
-#define RINGBUFFER_LINES 16
+extern const VGA_Mode VGA_Modes[VGA_MODE_COUNT];
+extern const VGA_Mode *vga_mode;      // mode currently on screen
+
+#define LINEBUFFERS 2 //ping-pong halves, DMA runs circular across both
+
+// One band of scanlines in the image area. Bands follow each other from the
+// first image line; lines past the last band are black.
+typedef struct {
+	const uint8_t *src;               // first source row: vram, text cells or tile map. Unused for FB_FORMAT_STREAM
+	uint16_t stride;                  // bytes between source rows of the bitmap formats
+	uint16_t hoffset;                 // bytes skipped at the start of each row, cells for text and tiles
+	uint16_t lines;                   // scanlines in the band, 0 for the rest of the image
+	uint8_t repeat;                   // scanlines per source row (vertical zoom), 0 for the mode's upscale
+	uint8_t format;                   // FB_Format_t. ATTR, FRC and RLE bands must read from vram, no HIRES bands
+} VGA_DisplayEntry_t;
+
+// Procedural row source for FB_FORMAT_CALLBACK. Runs in the line DMA interrupt
+// and must fill all HRES bytes of line; see VGA_Profile_t.callback_max.
+typedef void (*VGA_LineCallback_t)(uint8_t *line, uint16_t row);
+
+// Raster actions of the copper list
+typedef enum {
+	COPPER_PALETTE,                   // palette[index] = value
+	COPPER_BORDER,                    // color of lines outside the image and past the last band
+	COPPER_HOFFSET,                   // bytes added to every band's hoffset
+} VGA_CopperOp_t;
+
+// Copper list entry, lists are sorted by line
+typedef struct {
+	uint16_t line;                    // scanline counted like current_line, VSYNC is line 0
+	uint8_t op;                       // VGA_CopperOp_t
+	uint8_t index;                    // palette entry for COPPER_PALETTE
+	uint16_t value;                   // color or offset
+} VGA_CopperEntry_t;
+
+#ifndef VGA_PROFILE
+#define VGA_PROFILE 1 //measure line ISR cycles with DWT->CYCCNT
+#endif
+
+// Worst case cycles spent in the line interrupts, read with a debugger or VGA_GetProfile()
+typedef struct {
+	uint32_t hsync_max;               // TIM2 update handler
+	uint32_t line_max;                // DMA half/full handler incl. line preparation
+	uint32_t budget;                  // cycles available per scanline in the current mode
+	uint32_t overruns;                // both DMA halves finished before the handler ran
+	uint32_t callback_max;            // VGA_LineCallback_t, part of line_max
+} VGA_Profile_t;
 
-uint16_t current_line;
-uint8_t lineBuffer[HRESFULL];
+extern volatile uint16_t current_line;
+extern uint8_t lineBuffer[LINEBUFFERS][LINE_BYTES];
 
 void VGA_Init(void);
-void PrepareLineBuffer(const uint8_t *imageData, uint8_t imageWidth, uint8_t imageHeight);
+void VGA_SetMode(VGA_ModeId mode);
+uint8_t VGA_SetDisplayList(const VGA_DisplayEntry_t *list, uint8_t count);
+uint8_t VGA_DisplayListPending(void);
+void VGA_SetCopperList(const VGA_CopperEntry_t *list, uint8_t count);
+void VGA_SetLineCallback(VGA_LineCallback_t callback);
+void VGA_HSync_IRQHandler(void);
+void VGA_LineDMA_IRQHandler(void);
+const VGA_Profile_t* VGA_GetProfile(void);
+void PrepareLineBuffer(uint8_t *buffer, uint16_t line);
 void fastCopy160(uint8_t *dst, const uint8_t *src);
 
 #endif /* INC_VGA_H_ */
@@ -0,0 +1,27 @@
+/*
+ * VGA_SPI.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#ifndef INC_VGA_SPI_H_
+#define INC_VGA_SPI_H_
+
+#include "main.h"
+#include "framebuffer.h"
+
+// 1bpp scanout on SPI1 MOSI (PA7), used while fb_format is FB_FORMAT_HIRES.
+// MOSI drives the DAC inputs that should light up, e.g. all of R/G/B through
+// their resistors for white on black. PB0-7 stay low.
+#define SPI_DIV 4                                // 72MHz / 4 = 18MHz pixel clock (SPI BR = 1)
+#define SPI_HRES 400                             // pixels per row, 22.2us
+#define SPI_ROW_BYTES (SPI_HRES / 8)
+#define SPI_VRES (VRAM_SIZE / SPI_ROW_BYTES)     // 192 rows fit in vram
+#define SPI_LINE_BYTES (SPI_ROW_BYTES + 2)       // plus a black halfword that leaves MOSI low
+
+void VGA_SPI_Start(uint16_t top, uint8_t upscale);
+void VGA_SPI_Stop(void);
+void VGA_SPI_IRQHandler(void);
+
+#endif /* INC_VGA_SPI_H_ */
@@ -0,0 +1,104 @@
+#define FONT_WIDTH 4
+#define FONT_HEIGHT 8
+#define FONT_FIRST 0x20
+#define FONT_GLYPHS 95
+
+// ASCII 0x20-0x7E, one row per byte, pixels in the low nibble with the leftmost in bit 3.
+// Glyphs are 3 pixels wide, bit 0 and row 0 are the gap between cells.
+const uint8_t font4x8[FONT_GLYPHS][FONT_HEIGHT] = {
+  { 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0 }, // space
+  { 0x0, 0x4, 0x4, 0x4, 0x0, 0x4, 0x0, 0x0 }, // !
+  { 0x0, 0xA, 0xA, 0x0, 0x0, 0x0, 0x0, 0x0 }, // "
+  { 0x0, 0xA, 0xE, 0xA, 0xE, 0xA, 0x0, 0x0 }, // #
+  { 0x0, 0x6, 0xC, 0x4, 0x6, 0xC, 0x0, 0x0 }, // $
+  { 0x0, 0x8, 0x2, 0x4, 0x8, 0x2, 0x0, 0x0 }, // %
+  { 0x0, 0x4, 0xA, 0x4, 0xA, 0x6, 0x0, 0x0 }, // &
+  { 0x0, 0x4, 0x4, 0x0, 0x0, 0x0, 0x0, 0x0 }, // '
+  { 0x0, 0x2, 0x4, 0x4, 0x4, 0x2, 0x0, 0x0 }, // (
+  { 0x0, 0x8, 0x4, 0x4, 0x4, 0x8, 0x0, 0x0 }, // )
+  { 0x0, 0x0, 0xA, 0x4, 0xA, 0x0, 0x0, 0x0 }, // *
+  { 0x0, 0x0, 0x4, 0xE, 0x4, 0x0, 0x0, 0x0 }, // +
+  { 0x0, 0x0, 0x0, 0x0, 0x0, 0x4, 0x8, 0x0 }, // ,
+  { 0x0, 0x0, 0x0, 0xE, 0x0, 0x0, 0x0, 0x0 }, // -
+  { 0x0, 0x0, 0x0, 0x0, 0x0, 0x4, 0x0, 0x0 }, // .
+  { 0x0, 0x2, 0x2, 0x4, 0x8, 0x8, 0x0, 0x0 }, // /
+  { 0x0, 0xE, 0xA, 0xA, 0xA, 0xE, 0x0, 0x0 }, // 0
+  { 0x0, 0x4, 0xC, 0x4, 0x4, 0xE, 0x0, 0x0 }, // 1
+  { 0x0, 0xC, 0x2, 0x4, 0x8, 0xE, 0x0, 0x0 }, // 2
+  { 0x0, 0xC, 0x2, 0x4, 0x2, 0xC, 0x0, 0x0 }, // 3
+  { 0x0, 0xA, 0xA, 0xE, 0x2, 0x2, 0x0, 0x0 }, // 4
+  { 0x0, 0xE, 0x8, 0xC, 0x2, 0xC, 0x0, 0x0 }, // 5
+  { 0x0, 0x6, 0x8, 0xE, 0xA, 0xE, 0x0, 0x0 }, // 6
+  { 0x0, 0xE, 0x2, 0x4, 0x4, 0x4, 0x0, 0x0 }, // 7
+  { 0x0, 0xE, 0xA, 0xE, 0xA, 0xE, 0x0, 0x0 }, // 8
+  { 0x0, 0xE, 0xA, 0xE, 0x2, 0xC, 0x0, 0x0 }, // 9
+  { 0x0, 0x0, 0x4, 0x0, 0x4, 0x0, 0x0, 0x0 }, // :
+  { 0x0, 0x0, 0x4, 0x0, 0x4, 0x8, 0x0, 0x0 }, // ;
+  { 0x0, 0x2, 0x4, 0x8, 0x4, 0x2, 0x0, 0x0 }, // <
+  { 0x0, 0x0, 0xE, 0x0, 0xE, 0x0, 0x0, 0x0 }, // =
+  { 0x0, 0x8, 0x4, 0x2, 0x4, 0x8, 0x0, 0x0 }, // >
+  { 0x0, 0xC, 0x2, 0x4, 0x0, 0x4, 0x0, 0x0 }, // ?
+  { 0x0, 0x4, 0xA, 0xE, 0x8, 0x6, 0x0, 0x0 }, // @
+  { 0x0, 0x4, 0xA, 0xE, 0xA, 0xA, 0x0, 0x0 }, // A
+  { 0x0, 0xC, 0xA, 0xC, 0xA, 0xC, 0x0, 0x0 }, // B
+  { 0x0, 0x6, 0x8, 0x8, 0x8, 0x6, 0x0, 0x0 }, // C
+  { 0x0, 0xC, 0xA, 0xA, 0xA, 0xC, 0x0, 0x0 }, // D
+  { 0x0, 0xE, 0x8, 0xE, 0x8, 0xE, 0x0, 0x0 }, // E
+  { 0x0, 0xE, 0x8, 0xE, 0x8, 0x8, 0x0, 0x0 }, // F
+  { 0x0, 0x6, 0x8, 0xA, 0xA, 0x6, 0x0, 0x0 }, // G
+  { 0x0, 0xA, 0xA, 0xE, 0xA, 0xA, 0x0, 0x0 }, // H
+  { 0x0, 0xE, 0x4, 0x4, 0x4, 0xE, 0x0, 0x0 }, // I
+  { 0x0, 0x2, 0x2, 0x2, 0xA, 0x4, 0x0, 0x0 }, // J
+  { 0x0, 0xA, 0xA, 0xC, 0xA, 0xA, 0x0, 0x0 }, // K
+  { 0x0, 0x8, 0x8, 0x8, 0x8, 0xE, 0x0, 0x0 }, // L
+  { 0x0, 0xA, 0xE, 0xE, 0xA, 0xA, 0x0, 0x0 }, // M
+  { 0x0, 0xC, 0xA, 0xA, 0xA, 0xA, 0x0, 0x0 }, // N
+  { 0x0, 0x4, 0xA, 0xA, 0xA, 0x4, 0x0, 0x0 }, // O
+  { 0x0, 0xC, 0xA, 0xC, 0x8, 0x8, 0x0, 0x0 }, // P
+  { 0x0, 0x4, 0xA, 0xA, 0xE, 0x6, 0x0, 0x0 }, // Q
+  { 0x0, 0xC, 0xA, 0xC, 0xA, 0xA, 0x0, 0x0 }, // R
+  { 0x0, 0x6, 0x8, 0x4, 0x2, 0xC, 0x0, 0x0 }, // S
+  { 0x0, 0xE, 0x4, 0x4, 0x4, 0x4, 0x0, 0x0 }, // T
+  { 0x0, 0xA, 0xA, 0xA, 0xA, 0x6, 0x0, 0x0 }, // U
+  { 0x0, 0xA, 0xA, 0xA, 0x4, 0x4, 0x0, 0x0 }, // V
+  { 0x0, 0xA, 0xA, 0xE, 0xE, 0xA, 0x0, 0x0 }, // W
+  { 0x0, 0xA, 0xA, 0x4, 0xA, 0xA, 0x0, 0x0 }, // X
+  { 0x0, 0xA, 0xA, 0x4, 0x4, 0x4, 0x0, 0x0 }, // Y
+  { 0x0, 0xE, 0x2, 0x4, 0x8, 0xE, 0x0, 0x0 }, // Z
+  { 0x0, 0xE, 0x8, 0x8, 0x8, 0xE, 0x0, 0x0 }, // [
+  { 0x0, 0x8, 0x8, 0x4, 0x2, 0x2, 0x0, 0x0 }, // backslash
+  { 0x0, 0xE, 0x2, 0x2, 0x2, 0xE, 0x0, 0x0 }, // ]
+  { 0x0, 0x4, 0xA, 0x0, 0x0, 0x0, 0x0, 0x0 }, // ^
+  { 0x0, 0x0, 0x0, 0x0, 0x0, 0xE, 0x0, 0x0 }, // _
+  { 0x0, 0x8, 0x4, 0x0, 0x0, 0x0, 0x0, 0x0 }, // `
+  { 0x0, 0x0, 0x6, 0xA, 0xA, 0x6, 0x0, 0x0 }, // a
+  { 0x0, 0x8, 0xC, 0xA, 0xA, 0xC, 0x0, 0x0 }, // b
+  { 0x0, 0x0, 0x6, 0x8, 0x8, 0x6, 0x0, 0x0 }, // c
+  { 0x0, 0x2, 0x6, 0xA, 0xA, 0x6, 0x0, 0x0 }, // d
+  { 0x0, 0x0, 0x4, 0xE, 0x8, 0x6, 0x0, 0x0 }, // e
+  { 0x0, 0x2, 0x4, 0xE, 0x4, 0x4, 0x0, 0x0 }, // f
+  { 0x0, 0x0, 0x6, 0xA, 0xA, 0x6, 0x2, 0xC }, // g
+  { 0x0, 0x8, 0xC, 0xA, 0xA, 0xA, 0x0, 0x0 }, // h
+  { 0x0, 0x4, 0x0, 0x4, 0x4, 0x4, 0x0, 0x0 }, // i
+  { 0x0, 0x2, 0x0, 0x2, 0x2, 0x2, 0xA, 0x4 }, // j
+  { 0x0, 0x8, 0xA, 0xC, 0xC, 0xA, 0x0, 0x0 }, // k
+  { 0x0, 0xC, 0x4, 0x4, 0x4, 0xE, 0x0, 0x0 }, // l
+  { 0x0, 0x0, 0xE, 0xE, 0xA, 0xA, 0x0, 0x0 }, // m
+  { 0x0, 0x0, 0xC, 0xA, 0xA, 0xA, 0x0, 0x0 }, // n
+  { 0x0, 0x0, 0x4, 0xA, 0xA, 0x4, 0x0, 0x0 }, // o
+  { 0x0, 0x0, 0xC, 0xA, 0xA, 0xC, 0x8, 0x8 }, // p
+  { 0x0, 0x0, 0x6, 0xA, 0xA, 0x6, 0x2, 0x2 }, // q
+  { 0x0, 0x0, 0x6, 0x8, 0x8, 0x8, 0x0, 0x0 }, // r
+  { 0x0, 0x0, 0x6, 0x8, 0x2, 0xC, 0x0, 0x0 }, // s
+  { 0x0, 0x4, 0xE, 0x4, 0x4, 0x2, 0x0, 0x0 }, // t
+  { 0x0, 0x0, 0xA, 0xA, 0xA, 0x6, 0x0, 0x0 }, // u
+  { 0x0, 0x0, 0xA, 0xA, 0xA, 0x4, 0x0, 0x0 }, // v
+  { 0x0, 0x0, 0xA, 0xA, 0xE, 0xE, 0x0, 0x0 }, // w
+  { 0x0, 0x0, 0xA, 0x4, 0x4, 0xA, 0x0, 0x0 }, // x
+  { 0x0, 0x0, 0xA, 0xA, 0xA, 0x6, 0x2, 0xC }, // y
+  { 0x0, 0x0, 0xE, 0x6, 0xC, 0xE, 0x0, 0x0 }, // z
+  { 0x0, 0x2, 0x4, 0xC, 0x4, 0x2, 0x0, 0x0 }, // {
+  { 0x0, 0x4, 0x4, 0x4, 0x4, 0x4, 0x0, 0x0 }, // |
+  { 0x0, 0x8, 0x4, 0x6, 0x4, 0x8, 0x0, 0x0 }, // }
+  { 0x0, 0x0, 0xC, 0x6, 0x0, 0x0, 0x0, 0x0 }, // ~
+};
@@ -0,0 +1,81 @@
+/*
+ * framebuffer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#ifndef INC_FRAMEBUFFER_H_
+#define INC_FRAMEBUFFER_H_
+
+#include <stdint.h>
+#include "usb_frame_buffer.h"
+#include "rle.h"
+
+#define VRAM_SIZE ((HRES * VRES) / 2)  // 9600, one resident 4bpp frame
+#define PALETTE_SIZE 16
+
+// FB_FORMAT_ATTR: 1bpp bitmap followed by a foreground, background pair per 8x8 cell
+#define ATTR_CELL 8
+#define ATTR_COLS (HRES / ATTR_CELL)           // 20
+#define ATTR_ROWS (VRES / ATTR_CELL)           // 15
+#define ATTR_BASE ((HRES / 8) * VRES)          // 2400, attributes follow the bitmap in vram
+
+// FB_FORMAT_RLE: VRES little endian row offsets into vram, then rows coded as in rle.h
+#define RLE_INDEX_SIZE (VRES * 2)              // 240, row data starts here
+
+// Rectangle updates held back for the next vertical blank, see FB_WriteRect
+#define FB_STAGE_SIZE 256                      // power of two
+#define FB_STAGE_CHUNK 32                      // bytes applied per blank line, see FB_ApplyStaged
+
+// Where PrepareLineBuffer takes source rows from
+typedef enum {
+    FB_FORMAT_STREAM,                 // RGB332 rows streamed through the ring buffer
+    FB_FORMAT_4BPP,                   // resident 4bpp frame in vram, two pixels per byte, high nibble first
+    FB_FORMAT_2BPP,                   // resident 2bpp frame, palette entries 0-3, leftmost pixel in the top bits
+    FB_FORMAT_1BPP,                   // resident 1bpp frame, palette 0 background / 1 foreground, MSB first
+    FB_FORMAT_TEXT,                   // 40x30 character cells with attributes, see textmode.h
+    FB_FORMAT_TILES,                  // 20x15 map of 8x8 flash tiles plus sprites, see tilemap.h
+    FB_FORMAT_HIRES,                  // 400x192 1bpp scanned out through SPI1, see VGA_SPI.h
+    FB_FORMAT_ATTR,                   // 1bpp bitmap, set bits in the cell's foreground RGB332, clear in its background
+    FB_FORMAT_FRC,                    // 4bpp frame, RGB444 palette shown as two alternating RGB332 levels
+    FB_FORMAT_CALLBACK,               // rows generated by the function given to VGA_SetLineCallback
+    FB_FORMAT_RLE,                    // resident RGB332 frame, each row run-length encoded, found through an index
+    FB_FORMAT_STREAM_RLE,             // run-length coded rows through the ring buffer, decoded by the scanout
+    FB_FORMAT_STREAM_LZ,              // RGB332 rows decoded into the ring buffer from an LZ stream, see lz.h
+} FB_Format_t;
+
+
+extern uint8_t vram[VRAM_SIZE];
+extern uint8_t palette[PALETTE_SIZE];
+extern volatile FB_Format_t fb_format;
+extern volatile uint16_t fb_scroll_x;     // bytes, wraps within the row
+extern volatile uint16_t fb_scroll_y;     // rows of the format, wraps within the frame
+extern const uint32_t fb_nibble_mask[16];
+extern volatile uint8_t fb_frame_parity;   // toggled by VGA at every frame start
+
+void FB_Init(void);
+void FB_SetFormat(FB_Format_t format);
+void FB_SetPalette(const uint8_t *colors, uint8_t first, uint8_t count);
+void FB_SetPaletteEntry(uint8_t index, uint8_t color);
+void FB_SetPalette444(const uint8_t *colors, uint8_t first, uint8_t count);
+void FB_SetScroll(uint16_t x, uint16_t y);
+void FB_Write(uint16_t pos, const uint8_t *data, uint16_t len);
+void FB_SetAttributes(const uint8_t *data, uint16_t len);
+void FB_WriteColumn(uint16_t pos, const uint8_t *data, uint16_t len, uint8_t width);
+bool FB_WriteRect(uint16_t pos, uint16_t done, const uint8_t *data, uint16_t len, uint8_t width, bool at_vblank);
+void FB_CommitStaged(void);
+void FB_DiscardStaged(void);
+void FB_LatchStaged(void);
+void FB_ApplyStaged(uint16_t max_bytes);
+uint16_t FB_RowBytes(FB_Format_t format);
+void FB_ExpandLine(uint8_t *dst, const uint8_t *src, FB_Format_t format);
+void FB_ExpandRow(uint8_t *dst, uint16_t row, uint16_t hoffset, FB_Format_t format);
+void FB_Expand4bpp(uint8_t *dst, const uint8_t *src, uint16_t len);
+void FB_Expand2bpp(uint8_t *dst, const uint8_t *src, uint16_t len);
+void FB_Expand1bpp(uint8_t *dst, const uint8_t *src, uint16_t len);
+void FB_ExpandAttr(uint8_t *dst, const uint8_t *src, const uint8_t *attrs, uint16_t len);
+void FB_Expand4bppFRC(uint8_t *dst, const uint8_t *src, uint16_t len, uint8_t phase);
+void FB_ExpandRLE(uint8_t *dst, uint16_t row);
+
+#endif /* INC_FRAMEBUFFER_H_ */
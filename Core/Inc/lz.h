@@ -0,0 +1,53 @@
+/*
+ * lz.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * LZ4 style byte codec of FB_FORMAT_STREAM_LZ. Plain C without HAL or
+ * display dependencies, the host encoder builds the same file.
+ *
+ * A sequence is a token (literal count in the high nibble, match length
+ * minus LZ_MATCH_MIN in the low nibble, 15 meaning more length bytes of up
+ * to 255 follow), the literals, a 2 byte little endian offset back into the
+ * output and the match length bytes. The decoder writes into a circular
+ * window, the scanout ring on the target, so offsets reach at most
+ * window - 1 bytes back. Decoding can stop and resume at any input or
+ * output byte.
+ */
+
+#ifndef INC_LZ_H_
+#define INC_LZ_H_
+
+#include <stdint.h>
+
+#define LZ_MATCH_MIN 4
+#define LZ_HASH_BITS 12
+#define LZ_HASH_SIZE (1 << LZ_HASH_BITS)          // entries of the encoder's match table
+#define LZ_BOUND(len) ((len) + (len) / 255 + 16)  // largest encoding of len bytes
+
+typedef enum {
+    LZ_TOKEN,
+    LZ_LITERAL_LENGTH,
+    LZ_LITERALS,
+    LZ_OFFSET_LOW,
+    LZ_OFFSET_HIGH,
+    LZ_MATCH_LENGTH,
+    LZ_MATCH,
+} LZ_State_t;
+
+typedef struct {
+    uint8_t *window;                  // circular output
+    uint16_t size;                    // window bytes
+    uint16_t pos;                     // next output byte in window
+    uint8_t state;                    // LZ_State_t
+    uint16_t literal;                 // literals still to copy
+    uint16_t match;                   // match bytes still to copy
+    uint16_t offset;
+} LZ_Decoder_t;
+
+void LZ_Reset(LZ_Decoder_t *lz, uint8_t *window, uint16_t size, uint16_t pos);
+uint16_t LZ_Decode(LZ_Decoder_t *lz, const uint8_t *src, uint16_t len, uint16_t *room);
+uint32_t LZ_Encode(uint8_t *dst, const uint8_t *src, uint32_t len, uint16_t window, uint32_t *table);
+
+#endif /* INC_LZ_H_ */
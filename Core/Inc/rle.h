@@ -0,0 +1,30 @@
+/*
+ * rle.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Run-length line codec of FB_FORMAT_RLE and FB_FORMAT_STREAM_RLE. Plain C
+ * without HAL or display dependencies, the host encoder builds the same file.
+ *
+ * PackBits style runs: control 0-127 is followed by control + 1 literal
+ * pixels, control 128-255 repeats the following pixel control - 125 times.
+ * A line has at most RLE_MAX_RUNS controls, so its decode time is bounded;
+ * the encoder falls back to a literal line for content with more runs.
+ */
+
+#ifndef INC_RLE_H_
+#define INC_RLE_H_
+
+#include <stdint.h>
+
+#define RLE_LITERAL_MAX 128                    // longest literal run
+#define RLE_REPEAT_MIN 3                       // shortest repeat run, shorter ones go into literals
+#define RLE_REPEAT_MAX (255 - RLE_LITERAL_MAX + RLE_REPEAT_MIN)  // 130
+#define RLE_MAX_RUNS 32                        // controls per line the decoder follows
+#define RLE_LINE_MAX(width) ((width) + ((width) + RLE_LITERAL_MAX - 1) / RLE_LITERAL_MAX)  // literal line
+
+uint16_t RLE_EncodeLine(uint8_t *dst, const uint8_t *src, uint16_t width);
+uint16_t RLE_DecodeLine(uint8_t *dst, uint16_t width, const uint8_t *src, uint16_t size);
+
+#endif /* INC_RLE_H_ */
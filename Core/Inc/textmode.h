@@ -0,0 +1,30 @@
+/*
+ * textmode.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#ifndef INC_TEXTMODE_H_
+#define INC_TEXTMODE_H_
+
+#include <stdint.h>
+#include "framebuffer.h"
+
+#define TEXT_COLS 40                       // HRES / 4 pixel cells
+#define TEXT_ROWS 30                       // 8 glyph rows each, two per source row
+#define TEXT_CELLS (TEXT_COLS * TEXT_ROWS)
+#define TEXT_LINES (TEXT_ROWS * 8)         // glyph rows per frame
+#define TEXT_DEFAULT_ATTR 0x07             // palette 7 on palette 0
+
+// Characters and attributes share vram with the resident bitmap formats.
+// Attribute byte: low nibble foreground palette index, high nibble background.
+#define text_chars (vram)
+#define text_attrs (vram + TEXT_CELLS)
+
+void TEXT_Clear(uint8_t attr);
+void TEXT_Print(uint8_t col, uint8_t row, uint8_t attr, const char *str);
+void TEXT_Write(const uint8_t *data, uint16_t len);
+void TEXT_RenderLine(uint8_t *dst, const uint8_t *chars, uint16_t line);
+
+#endif /* INC_TEXTMODE_H_ */
@@ -0,0 +1,38 @@
+/*
+ * tilemap.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#ifndef INC_TILEMAP_H_
+#define INC_TILEMAP_H_
+
+#include <stdint.h>
+#include "framebuffer.h"
+
+#define TILE_SIZE 8
+#define TILEMAP_COLS (HRES / TILE_SIZE)    // 20
+#define TILEMAP_ROWS (VRES / TILE_SIZE)    // 15
+#define TILEMAP_CELLS (TILEMAP_COLS * TILEMAP_ROWS)
+#define TILE_KEY 0xC7                      // transparent color in sprite tiles
+#define SPRITE_COUNT 8
+#define SPRITE_HIDDEN 0xFF
+
+// Tile indices, one byte per cell, share vram with the other resident formats
+#define tilemap (vram)
+
+// Positions are offset by TILE_SIZE so a sprite can be partly off the top or left edge
+typedef struct {
+    uint8_t x;                        // screen x + TILE_SIZE
+    uint8_t y;                        // screen y + TILE_SIZE
+    uint8_t tile;                     // tile index, SPRITE_HIDDEN to disable
+} Sprite_t;
+
+extern Sprite_t sprites[SPRITE_COUNT];
+
+void TILE_Init(void);
+void TILE_SetSprites(const uint8_t *data, uint16_t len);
+void TILE_RenderRow(uint8_t *dst, const uint8_t *map, uint16_t row);
+
+#endif /* INC_TILEMAP_H_ */
@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "lz.h"
 
 //from VGA.h
 #define VRES 120                       // Vertical resolution
@@ -20,11 +21,37 @@
 #define CMD_DATA_CHUNK   0xF1  // Host signals: data chunk follows
 #define CMD_FRAME_END    0xF2  // STM32 signals: frame complete
 #define CMD_REQUEST_DATA 0xA0  // STM32 requests: send more data
+#define CMD_FORMAT_STREAM 0xF3 // Host signals: RGB332 rows through the ring buffer
+#define CMD_FORMAT_4BPP  0xF4  // Host signals: resident 4bpp frame, data chunks go to vram
+#define CMD_PALETTE      0xF5  // Host signals: next packet holds RGB332 palette entries from index 0
+#define CMD_FORMAT_2BPP  0xF6  // Host signals: resident 2bpp frame, 4800 bytes
+#define CMD_FORMAT_1BPP  0xF7  // Host signals: resident 1bpp frame, 2400 bytes
+#define CMD_FORMAT_TEXT  0xF8  // Host signals: text mode, data chunks are column, row, attribute, characters
+#define CMD_FORMAT_TILES 0xF9  // Host signals: tile mode, data chunks are tile indices placed by offset
+#define CMD_SPRITES      0xFA  // Host signals: next packet holds index, x, y, tile groups
+#define CMD_SCROLL       0xFB  // Host signals: next packet holds x bytes, y rows for the resident frame
+#define CMD_SEEK         0xFC  // Host signals: next packet holds vram offset (2 bytes LE) and column width, 0 for rows
+#define CMD_FORMAT_HIRES 0xFD  // Host signals: 400x192 1bpp on SPI1 MOSI, 9600 bytes
+#define CMD_FORMAT_ATTR  0xFE  // Host signals: 1bpp bitmap (2400 bytes) then 20x15 foreground, background pairs
+#define CMD_ATTRIBUTES   0xA1  // Host signals: next packet holds column, row, foreground, background groups
+#define CMD_FORMAT_FRC   0xA2  // Host signals: resident 4bpp frame shown through the RGB444 palette
+#define CMD_PALETTE_444  0xA3  // Host signals: next packet holds RGB444 palette entries from index 0, 0x0R 0xGB
+#define CMD_LINE_DATA    0xA4  // Host signals: data packets carry a line header from now on, CMD_DATA_CHUNK ends it
+#define CMD_FORMAT_RLE   0xA5  // Host signals: resident run-length coded frame, row index then rows, written by offset
+#define CMD_RECT         0xA6  // Host signals: next packet holds x bytes, y rows, width bytes, height rows, flags, then data
+#define RECT_AT_VBLANK   0x01  // CMD_RECT flag: show the whole rectangle at the next frame start
+#define RECT_DROPPED     0x80  // not sent by the host: rectangle rejected or out of stage room, its data is ignored
+#define RECT_HEADER 5
+#define CMD_FORMAT_STREAM_RLE 0xA7  // Host signals: ring rows as records, length byte then a coded row, ITEM_SIZE for a plain row
+#define CMD_FORMAT_STREAM_LZ 0xA8  // Host signals: each CMD_DATA_CHUNK starts an LZ stream of ring rows, offsets below RING_BUFFER_SIZE
 
 
 #define ITEM_SIZE HRES                // Horizontal resolution
 #define WRITE_CHUNK 480               // USB write chunk size
-#define RING_BUFFER_SIZE ((VRES*HRES)/4)  // Total buffer size 4,800
+#define RING_LINES 32                 // Line slots, power of two
+#define RING_BUFFER_SIZE (RING_LINES * ITEM_SIZE)  // Total buffer size 5,120
+#define USB_RX_PACKET 64              // CDC_DATA_FS_OUT_PACKET_SIZE, most bytes one OUT packet writes
+#define LINE_HEADER 5                 // CMD_LINE_DATA, frame id, line, column, length
 
 
 // Frame state machine states
@@ -32,14 +59,31 @@ typedef enum {
     FRAME_STATE_IDLE,                 // No frame active, waiting for FRAME_START
     FRAME_STATE_RECEIVING,            // Currently receiving frame data
     FRAME_STATE_COMPLETE,             // Frame fully received, displaying
+    FRAME_STATE_PALETTE,              // Next packet is palette data
+    FRAME_STATE_SPRITES,              // Next packet is sprite data
+    FRAME_STATE_SCROLL,               // Next packet is scroll registers
+    FRAME_STATE_SEEK,                 // Next packet is a write position
+    FRAME_STATE_ATTRIBUTES,           // Next packet is cell colors
+    FRAME_STATE_PALETTE_444,          // Next packet is RGB444 palette data
+    FRAME_STATE_RECT,                 // Next packet is a rectangle header
+    FRAME_STATE_RECT_DATA,            // Receiving rectangle data
 } FrameState_t;
 
 
+// Single producer (USB) / single consumer (scanout) ring of whole lines.
+// Each side only writes its own index, so neither needs to mask interrupts.
 typedef struct {
-    uint8_t data[RING_BUFFER_SIZE];   // Actual pixel data storage
-    uint16_t write_pos;               // Where USB writes next byte (0 to RING_BUFFER_SIZE-1)
-    uint16_t read_pos;                // Where VGA reads next byte (0 to RING_BUFFER_SIZE-1)
-    uint16_t available_bytes;         // How many bytes are ready to read
+    uint8_t data[RING_LINES][ITEM_SIZE];  // Line slots
+    uint8_t spill[USB_RX_PACKET];     // Tail of a packet received in place past the last slot
+    uint8_t length[RING_LINES];       // FB_FORMAT_STREAM_RLE: bytes in each slot, ITEM_SIZE for a plain row
+    volatile uint16_t head;           // Lines published, free running, written by USB only
+    volatile uint16_t tail;           // Lines consumed, free running, written by scanout only
+    volatile uint16_t discard;        // Head at the last FRAME_END, scanout skips up to here
+    volatile uint8_t discard_seq;     // Bumped by USB after setting discard
+    uint8_t discard_ack;              // Last discard_seq seen by the scanout
+    uint16_t fill;                    // Bytes in the slot at head, USB only
+    uint8_t record;                   // FB_FORMAT_STREAM_RLE: bytes of the slot at head still to come, USB only
+    uint32_t overflows;               // Bytes dropped because all slots were full
 } RingBuffer_t;
 
 
@@ -48,6 +92,19 @@ typedef struct {
     uint16_t received_bytes;          // Total bytes received in current frame
     uint32_t frame_counter;           // Total frames received (for debugging)
     uint16_t processed_bytes;	      // Total bytes processed by VGA
+    uint8_t column_width;             // resident writes: bytes per row of a column, 0 for whole rows
+    bool line_data;                   // data packets carry a line header
+    bool frame_open;                  // frame_id is valid
+    uint8_t frame_id;                 // frame of the last accepted line packet
+    uint16_t frame_base;              // stream: ring head where line 0 of frame_id goes
+    uint16_t dropped_packets;         // line packets malformed, stale or without room
+    uint16_t rect_pos;                // CMD_RECT: vram offset of the top left corner
+    uint16_t rect_size;               // CMD_RECT: bytes in the rectangle
+    uint8_t rect_width;               // CMD_RECT: bytes per row
+    uint8_t rect_flags;               // CMD_RECT: RECT_*
+    uint16_t dropped_rects;           // CMD_RECT: starting past the row end or larger than the stage
+    uint32_t lz_cycles;               // DWT cycles spent decoding FB_FORMAT_STREAM_LZ
+    uint32_t lz_bytes;                // bytes decoded into the ring, lz_cycles / lz_bytes is cycles per byte
 } FrameManager_t;
 
 
@@ -61,8 +118,15 @@ extern void fastCopy160(uint8_t *dst, const uint8_t *src);
 void USB_FrameBuffer_Init(void);
 void USB_ProcessReceivedData(uint8_t* buf, uint32_t len);
 void SendCommands(uint8_t cmd);
-void RingBuffer_Write( uint8_t* data, uint16_t len);
+uint16_t RingBuffer_Write( uint8_t* data, uint16_t len);
 void RingBuffer_Read(uint8_t* output);
+uint16_t RingBuffer_WriteRecords(const uint8_t* data, uint16_t len);
+void RingBuffer_ReadRLE(uint8_t* output);
+void RingBuffer_Discard(void);
+uint16_t RingBuffer_Available(void);
+uint8_t* USB_RxBuffer(uint8_t *fallback);
+bool USB_RxHeld(void);
+void USB_FrameBuffer_Poll(void);
 
 
 
@@ -24,7 +24,7 @@ void USBTest_Function(void) {
 
     // Send data if we're receiving and buffer is low
     if (frame_manager.state == FRAME_STATE_RECEIVING) {
-        if (ring_buffer.available_bytes <= 160*10) {
+        if (RingBuffer_Available() <= 160*10) {
             // Calculate how much data we can send without exceeding frame size
             uint16_t remaining = (HRES * VRES) - frame_manager.received_bytes;
             uint16_t to_send = (remaining < WRITE_CHUNK) ? remaining : WRITE_CHUNK;
@@ -1,53 +1,514 @@
 #include "VGA.h"
 extern const uint8_t testData[]; //image data
+
+const VGA_Mode VGA_Modes[VGA_MODE_COUNT] = {
+	// name           hdiv  hvis  hfp  hsync hbp  hwhole  vvis vfp vsync vbp vwhole  h+ v+  dma up
+	{ "640x480@60",   3,    640,  16,  96,   48,  800,    480, 10, 2,    33, 525,    0, 0,  12, 4 },
+	{ "640x400@70",   3,    640,  16,  96,   48,  800,    400, 12, 2,    35, 449,    0, 1,  12, 3 },
+	{ "720x400@70",   1,    1830, 46,  275,  137, 2288,   400, 12, 2,    35, 449,    0, 1,  11, 3 }, //28.3MHz dots in 72MHz ticks
+	{ "800x600@56",   2,    800,  24,  72,   128, 1024,   600, 1,  2,    22, 625,    1, 1,  10, 5 },
+};
+
+const VGA_Mode *vga_mode = &VGA_Modes[VGA_MODE_640x480_60];
+static const VGA_Mode *volatile pending_mode;
+
+volatile uint16_t current_line;
+uint8_t lineBuffer[LINEBUFFERS][LINE_BYTES] __ALIGNED(4);
+
+static uint16_t image_top;               //first scanline showing source row 0
+static uint16_t image_bottom;            //first scanline after the last source row
+static uint16_t visible_top;             //first scanline after the vertical back porch
+static uint16_t visible_bottom;          //first scanline of the vertical front porch
+static uint16_t stage_end;               //first scanline not applying staged rectangles, see FB_ApplyStaged
+static uint16_t fill_line;               //scanline the next freed half is prepared for
+static uint8_t spi_active;               //pixels go out on SPI1 (FB_FORMAT_HIRES), see VGA_SPI.c
+static uint32_t held[LINEBUFFERS];       //band and source row each half holds, HELD_BLANK | color for a border line
+#define HELD_BLANK 0x80000000
+#define HELD_NONE 0xFFFFFFFF
+
+static const VGA_DisplayEntry_t *display_list;   //NULL: whole image from fb_format and vram
+static uint8_t display_count;
+static const VGA_DisplayEntry_t *pending_list;
+static uint8_t pending_count;
+static volatile uint8_t list_pending;
+static uint8_t band;                     //display list entry of the current line
+static uint16_t band_start;              //image line the band starts on
+static VGA_DisplayEntry_t default_entry = { vram, 0, 0, 0, 0, FB_FORMAT_STREAM };
+
+static const VGA_CopperEntry_t *copper_list;
+static uint8_t copper_count;
+static const VGA_CopperEntry_t *pending_copper;
+static uint8_t pending_copper_count;
+static volatile uint8_t copper_pending;
+static uint8_t copper_pos;               //next entry to run this frame
+static uint8_t border_color;
+static uint16_t copper_hoffset;
+static volatile VGA_LineCallback_t line_callback;
+static VGA_Profile_t profile;
+
+#if VGA_PROFILE
+#define PROFILE_START() uint32_t t0 = DWT->CYCCNT
+#define PROFILE_END(field) do { uint32_t dt = DWT->CYCCNT - t0; \
+		if (dt > profile.field) profile.field = dt; } while (0)
+#else
+#define PROFILE_START()
+#define PROFILE_END(field)
+#endif
+
+static void VGA_Resync(void);
+static void VGA_ApplyMode(const VGA_Mode *mode);
+static void VGA_RunCopper(void);
+static const VGA_DisplayEntry_t* FindBand(uint16_t displayLine);
+static void RenderRow(uint8_t *buffer, const VGA_DisplayEntry_t *entry, uint16_t row);
+
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
-	//tim 1 pixel clock (6mhz)
-	//tim 2 horizontal sync
+	//tim 1 pixel clock, one burst of LINE_BYTES per line started by tim 2
+	//tim 2 horizontal sync, handled by VGA_HSync_IRQHandler
 	//tim 3 vertical sync
 	if (htim == &htim3){
 		SendCommands(CMD_FRAME_END);
 
 	}
+}
 
-	if (htim != &htim2)
-		return;
-	current_line++;
-	// During visible vertical area
-	if (current_line > VBPORCH && current_line < (VBPORCH + VVISIBLE - VSYNC)) {
-		// Send pixel data for current row
-		DMA1_Channel5->CCR &= ~DMA_CCR_EN;  		// Disable
-		DMA1_Channel5->CMAR = (uint32_t) lineBuffer;
-		DMA1_Channel5->CNDTR = HRESFULL;        	// Reset counter
-		DMA1_Channel5->CCR |= DMA_CCR_EN;   		// Re-enable
-
-		PrepareLineBuffer(testData, HRES, VRES);
-	}
+/**
+ * TIM2 update interrupt, called directly from TIM2_IRQHandler
+ * Skips the HAL dispatch: only the update interrupt is enabled on TIM2,
+ * so the flag is cleared without reading SR first.
+ * The blank lines between vertical sync and the first prepared row copy
+ * staged rectangles, FB_STAGE_CHUNK bytes each.
+ */
+void VGA_HSync_IRQHandler(void) {
+	PROFILE_START();
+	TIM2->SR = ~(uint32_t)TIM_SR_UIF;
 	// Reset at end of frame
-	if (current_line >= WHOLEFRAME) {
+	if (++current_line >= vga_mode->vwhole) {
 		current_line = 0;
+		VGA_Resync();
+	} else if (current_line >= vga_mode->vsync && current_line < stage_end) {
+		FB_ApplyStaged(FB_STAGE_CHUNK);
+	}
+	if (copper_list) {
+		VGA_RunCopper();
+	}
+	PROFILE_END(hsync_max);
+}
+
+/**
+ * DMA1_Channel2 half/full transfer interrupt, called directly from DMA1_Channel2_IRQHandler
+ * Half transfer: DMA moved on to the second half, first half is free.
+ * Full transfer: DMA wrapped around to the first half, second half is free.
+ */
+void VGA_LineDMA_IRQHandler(void) {
+	PROFILE_START();
+	uint32_t isr = DMA1->ISR;
+	DMA1->IFCR = DMA_IFCR_CGIF2;
+
+	if ((isr & (DMA_ISR_HTIF2 | DMA_ISR_TCIF2)) == (DMA_ISR_HTIF2 | DMA_ISR_TCIF2)) {
+		// Missed a line, only the second half is safe to write now
+		profile.overruns++;
+		fill_line++;
+		PrepareLineBuffer(lineBuffer[1], fill_line++);
+	} else if (isr & DMA_ISR_HTIF2) {
+		PrepareLineBuffer(lineBuffer[0], fill_line++);
+	} else if (isr & DMA_ISR_TCIF2) {
+		PrepareLineBuffer(lineBuffer[1], fill_line++);
+	}
+	PROFILE_END(line_max);
+}
+
+/**
+ * Restart the circular DMA on the first half, once per frame in vertical blank
+ * Both halves are black here, so the restart is never visible. Every line is
+ * exactly LINE_BYTES TIM1 requests, so the halves stay in step for the frame;
+ * this only pins the first half to line 0 after start-up or a missed line.
+ * Runs at the start of the line, before the TIM1 burst is triggered.
+ * A mode requested with VGA_SetMode() and a display list from
+ * VGA_SetDisplayList() are switched in here as well. The DMA is re-armed
+ * first, so the rest never delays the line 0 burst; only a mode switch runs
+ * before it, as it reprograms the timers with the DMA stopped. Staged
+ * rectangles are only latched here and copied a few bytes per line after
+ * vertical sync, see VGA_HSync_IRQHandler().
+ */
+static void VGA_Resync(void) {
+	DMA1_Channel2->CCR &= ~DMA_CCR_EN;  			// Disable
+	if (pending_mode || (fb_format == FB_FORMAT_HIRES) != spi_active) {
+		VGA_ApplyMode(pending_mode ? pending_mode : vga_mode);
+		pending_mode = NULL;
+	}
+	if (!spi_active) {
+		DMA1_Channel2->CNDTR = LINEBUFFERS * LINE_BYTES;	// Reset counter
+		DMA1_Channel2->CCR |= DMA_CCR_EN;   			// Re-enable
+		fill_line = current_line + LINEBUFFERS;
+	}
+	if (list_pending) {
+		display_list = pending_list;
+		display_count = pending_count;
+		list_pending = 0;
+	}
+	band = 0;
+	band_start = 0;
+	fb_frame_parity ^= 1;                            // same edge as the TIM3 update
+	FB_LatchStaged();
+
+	if (copper_pending) {
+		copper_list = pending_copper;
+		copper_count = pending_copper_count;
+		copper_pending = 0;
+	}
+	copper_pos = 0;
+}
+
+/**
+ * Run the copper entries for the line prepared next
+ * Line buffers are filled LINEBUFFERS lines ahead, so an entry runs at the
+ * HSYNC of line - LINEBUFFERS and is seen by the first row rendered for its
+ * line. A row already rendered for earlier scanlines is not redrawn, so with
+ * upscale > 1 changes inside a source row show from the next row on.
+ */
+static void VGA_RunCopper(void) {
+	uint16_t target = current_line + LINEBUFFERS;
+	while (copper_pos < copper_count && copper_list[copper_pos].line <= target) {
+		const VGA_CopperEntry_t *entry = &copper_list[copper_pos++];
+		switch (entry->op) {
+		case COPPER_PALETTE:
+			FB_SetPaletteEntry(entry->index, entry->value);
+			break;
+		case COPPER_BORDER:
+			border_color = entry->value;
+			break;
+		case COPPER_HOFFSET:
+			copper_hoffset = entry->value;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/**
+ * Program TIM1/TIM2/TIM3 and the line logic for a mode
+ * Runs at line 0 with DMA stopped. The new TIM2 prescaler is loaded by the
+ * next update, so only this blank line has the old dot clock. Also moves the
+ * pixel output between GPIOB and SPI1 when FB_FORMAT_HIRES was selected or left.
+ *
+ * @param mode: entry of VGA_Modes
+ */
+static void VGA_ApplyMode(const VGA_Mode *mode) {
+	// Horizontal: TIM2 line length, HSYNC pulse and first pixel (CH2 starts TIM1 or the SPI DMA)
+	uint8_t hires = (fb_format == FB_FORMAT_HIRES);
+	uint16_t hpixels;
+	if (hires)
+		hpixels = ((uint32_t) SPI_HRES * SPI_DIV) / mode->hdiv;
+	else
+		hpixels = ((uint32_t) HRES * mode->dma_div) / mode->hdiv;
+	TIM2->PSC = mode->hdiv - 1;
+	TIM2->ARR = mode->hwhole - 1;
+	TIM2->CCR1 = mode->hsync;
+	TIM2->CCR2 = mode->hsync + mode->hbporch + (mode->hvisible - hpixels) / 2;
+	if (mode->hsync_positive)
+		TIM2->CCER &= ~TIM_CCER_CC1P;
+	else
+		TIM2->CCER |= TIM_CCER_CC1P;
+
+	// Vertical: TIM3 counts TIM2 TRGO, one edge per line
+	TIM3->ARR = mode->vwhole - 1;
+	TIM3->CCR1 = mode->vsync;
+	if (mode->vsync_positive)
+		TIM3->CCER &= ~TIM_CCER_CC1P;
+	else
+		TIM3->CCER |= TIM_CCER_CC1P;
+	TIM3->CNT = 0;
+
+	// Pixel clock: one DMA byte per TIM1 period
+	TIM1->ARR = mode->dma_div - 1;
+
+	vga_mode = mode;
+	visible_top = mode->vsync + mode->vbporch;
+	visible_bottom = visible_top + mode->vvisible;
+	stage_end = visible_top - LINEBUFFERS;  // rows are prepared LINEBUFFERS lines ahead
+	image_top = mode->vsync + mode->vbporch + (mode->vvisible - VRES * mode->upscale) / 2;
+	image_bottom = image_top + VRES * mode->upscale;
+	profile.budget = (uint32_t) mode->hwhole * mode->hdiv;
+
+	memset(lineBuffer, 0, sizeof(lineBuffer));
+	memset(held, 0xFF, sizeof(held));      // HELD_NONE, refilled on the next line
+
+	if (hires) {
+		uint8_t upscale = mode->vvisible / SPI_VRES;
+		GPIOB->ODR = 0x0000;
+		VGA_SPI_Start(visible_top + (mode->vvisible - SPI_VRES * upscale) / 2, upscale);
+	} else if (spi_active) {
+		VGA_SPI_Stop();
+	}
+	spi_active = hires;
+}
+
+/**
+ * Request a new video mode
+ * The switch happens at the start of the next frame, inside vertical blank.
+ *
+ * @param mode: index into VGA_Modes
+ */
+void VGA_SetMode(VGA_ModeId mode) {
+	if (mode < VGA_MODE_COUNT) {
+		pending_mode = &VGA_Modes[mode];
+	}
+}
+
+/**
+ * 1 if RenderRow() can generate the band's rows
+ * FB_ExpandLine() only knows the plain bitmap formats. Attribute cells and
+ * the RLE row index are found relative to vram and the FRC phase follows the
+ * frame row, so those bands have to read from vram. Hires only scans out
+ * through SPI1.
+ */
+static uint8_t BandSupported(const VGA_DisplayEntry_t *entry) {
+	switch (entry->format) {
+	case FB_FORMAT_STREAM:
+	case FB_FORMAT_STREAM_RLE:
+	case FB_FORMAT_STREAM_LZ:
+	case FB_FORMAT_TEXT:
+	case FB_FORMAT_TILES:
+	case FB_FORMAT_CALLBACK:
+	case FB_FORMAT_4BPP:
+	case FB_FORMAT_2BPP:
+	case FB_FORMAT_1BPP:
+		return 1;
+	case FB_FORMAT_ATTR:
+	case FB_FORMAT_FRC:
+	case FB_FORMAT_RLE:
+		return entry->src == vram;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Show a display list from the next frame on
+ * The swap happens in vertical blank, so a frame never mixes two lists. The
+ * list is used in place: keep it valid until VGA_DisplayListPending() returns
+ * 0 for its replacement, and build the next one in a second array. A list
+ * with a band RenderRow() cannot generate is refused and the current one
+ * stays, see VGA_DisplayEntry_t.format.
+ *
+ * @param list: bands from the top of the image, NULL for the whole image in fb_format
+ * @param count: number of entries
+ * @retval 1 if the list was taken, 0 if it was refused
+ */
+uint8_t VGA_SetDisplayList(const VGA_DisplayEntry_t *list, uint8_t count) {
+	for (uint8_t i = 0; list && i < count; i++) {
+		if (!BandSupported(&list[i])) {
+			return 0;
+		}
 	}
+	list_pending = 0;
+	pending_list = list;
+	pending_count = count;
+	list_pending = 1;
+	return 1;
+}
+
+/**
+ * 1 while a list passed to VGA_SetDisplayList() waits for vertical blank
+ */
+uint8_t VGA_DisplayListPending(void) {
+	return list_pending;
+}
+
+/**
+ * Replace the copper list from the next frame on
+ * Entries change state that stays until changed again, the palette included,
+ * so a list that changes something mid-frame should also set it back on an
+ * early line. Same lifetime rules as VGA_SetDisplayList().
+ *
+ * @param list: entries sorted by line, NULL to stop
+ * @param count: number of entries
+ */
+void VGA_SetCopperList(const VGA_CopperEntry_t *list, uint8_t count) {
+	copper_pending = 0;
+	pending_copper = list;
+	pending_copper_count = count;
+	copper_pending = 1;
+}
+
+/**
+ * Set the row generator of FB_FORMAT_CALLBACK
+ * Select it for the whole image with FB_SetFormat(FB_FORMAT_CALLBACK) or for
+ * one band of a display list. The callback gets the line buffer half and the
+ * source row counted from the top of its band, once per source row; repeated
+ * scanlines are copied as for the other formats, use repeat = 1 for every
+ * scanline. It runs inside the line interrupt, so it has to finish well within
+ * VGA_GetProfile()->budget (2400 cycles at 640x480) minus line_max of the
+ * other work; callback_max is its measured worst case.
+ *
+ * @param callback: row generator, NULL leaves callback rows untouched
+ */
+void VGA_SetLineCallback(VGA_LineCallback_t callback) {
+	line_callback = callback;
+}
+
+/**
+ * Worst case line interrupt cycles since VGA_Init
+ * Exception entry/exit (12 cycles each on the M3) is not included.
+ */
+const VGA_Profile_t* VGA_GetProfile(void) {
+	return &profile;
 }
 
 void VGA_Init(void) {
-	PrepareLineBuffer(testData, HRES, VRES);
-	HAL_DMA_Start(&hdma_tim1_up, (uint32_t) lineBuffer, (uint32_t) &GPIOB->ODR,
-	HRESFULL);
-	__HAL_TIM_ENABLE_DMA(&htim1, TIM_DMA_UPDATE);
+	memset(&profile, 0, sizeof(profile));
+	FB_Init();
+	TILE_Init();
+	VGA_ApplyMode(vga_mode);
+#if VGA_PROFILE
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+	// TIM2 CH2 (PWM2) rises at the first visible dot and is routed to TRGO.
+	// TIM3 counts lines on that edge, TIM1 is started by it.
+	TIM2->CCMR1 = (TIM2->CCMR1 & ~TIM_CCMR1_OC2M) | TIM_CCMR1_OC2M_2 | TIM_CCMR1_OC2M_1 | TIM_CCMR1_OC2M_0;
+	TIM2->CR2 = (TIM2->CR2 & ~TIM_CR2_MMS) | TIM_CR2_MMS_2 | TIM_CR2_MMS_0;
+
+	// TIM1 runs one-pulse for RCR + 1 = LINE_BYTES periods per trigger,
+	// each CC1 match requests one DMA byte. No DMA during porches or sync.
+	TIM1->CR1 &= ~TIM_CR1_CEN;
+	TIM1->CR1 |= TIM_CR1_OPM;
+	TIM1->RCR = LINE_BYTES - 1;
+	TIM1->CCR1 = 1;                         // matched once per period, also in the first one after the trigger
+	TIM1->CNT = 0;
+	TIM1->EGR = TIM_EGR_UG;                 // load RCR
+	TIM1->SR = 0;
+	TIM1->SMCR = (TIM1->SMCR & ~(TIM_SMCR_TS | TIM_SMCR_SMS)) | TIM_TS_ITR1 | TIM_SLAVEMODE_TRIGGER;
+
+	// Enables HT/TC interrupts, which are then served by VGA_LineDMA_IRQHandler
+	HAL_DMA_Start_IT(&hdma_tim1_ch1, (uint32_t) lineBuffer, (uint32_t) &GPIOB->ODR,
+	LINEBUFFERS * LINE_BYTES);
+	__HAL_TIM_ENABLE_DMA(&htim1, TIM_DMA_CC1);
 	GPIOB->ODR = 0x0000; // Clear all pixels
 
 }
 
-void PrepareLineBuffer(const uint8_t *imageData, uint8_t imageWidth,
-		uint8_t imageHeight) {
-	uint16_t displayLine = current_line - VBPORCH - 1;
-	if ((displayLine) % UPSCALE == 0) {
-		uint16_t SourceRow = ((displayLine) / UPSCALE);
-		if (SourceRow < VRES) {
-			//fastCopy160(lineBuffer + OFFSET, testData + (SourceRow * HRES)); //for testing without usb
-			RingBuffer_Read(lineBuffer + OFFSET);
+/**
+ * Fill one half of the line buffer for the given scanline
+ * Called from the DMA half/full transfer interrupt, so the half is never the
+ * one DMA is currently shifting out. Each source row is rendered once, the
+ * following scanlines copy it from the other half or keep it in place.
+ *
+ * @param buffer: half of lineBuffer that DMA has just finished
+ * @param line: scanline the buffer will be displayed on
+ */
+void PrepareLineBuffer(uint8_t *buffer, uint16_t line) {
+	uint8_t half = (buffer == lineBuffer[0]) ? 0 : 1;
+	uint16_t displayLine = line - image_top;
+	const VGA_DisplayEntry_t *entry = NULL;
+
+	if (line >= image_top && line < image_bottom) {
+		entry = FindBand(displayLine);
+	}
+	// Outside the image (blanking, letterbox and past the last band)
+	if (entry == NULL) {
+		uint8_t color = (line >= visible_top && line < visible_bottom) ? border_color : 0;
+		if (held[half] != (HELD_BLANK | color)) {
+			memset(buffer, color, HRES);
+			held[half] = HELD_BLANK | color;
 		}
+		return;
 	}
 
+	uint8_t repeat = entry->repeat ? entry->repeat : vga_mode->upscale;
+	uint16_t bandLine = displayLine - band_start;
+	uint16_t row;
+	if (entry->format == FB_FORMAT_TEXT) {
+		row = (bandLine * 2) / repeat; // glyph rows are half a source row
+	} else {
+		row = bandLine / repeat;
+	}
+
+	uint32_t key = ((uint32_t) band << 16) | row;
+	if (held[half] == key) {
+		return;
+	}
+	if (held[half ^ 1] == key) {
+		// Other half still holds this row from the previous line
+		fastCopy160(buffer, lineBuffer[half ^ 1]);
+	} else {
+		RenderRow(buffer, entry, row);
+	}
+	held[half] = key;
+}
+
+/**
+ * Display list entry for an image line
+ * Lines arrive in order, so the search carries on from the previous band and
+ * VGA_Resync() rewinds it once per frame.
+ *
+ * @param displayLine: scanline counted from image_top
+ * @return entry, or NULL past the last band
+ */
+static const VGA_DisplayEntry_t* FindBand(uint16_t displayLine) {
+	if (display_list == NULL) {
+		default_entry.format = fb_format;
+		default_entry.stride = FB_RowBytes(fb_format);
+		return &default_entry;
+	}
+	while (band < display_count) {
+		uint16_t lines = display_list[band].lines;
+		if (lines == 0 || displayLine < band_start + lines) {
+			return &display_list[band];
+		}
+		band_start += lines;
+		band++;
+	}
+	return NULL;
+}
+
+/**
+ * Generate one source row of a band
+ * Bands reading the resident frame from the start of vram go through the
+ * scroll registers, other sources are used as they are.
+ *
+ * @param buffer: line buffer half
+ * @param entry: band the row belongs to
+ * @param row: source row counted from entry->src, glyph row for text
+ */
+static void RenderRow(uint8_t *buffer, const VGA_DisplayEntry_t *entry, uint16_t row) {
+	uint16_t hoffset = entry->hoffset + copper_hoffset;
+	switch (entry->format) {
+	case FB_FORMAT_STREAM:
+	case FB_FORMAT_STREAM_LZ:
+		//fastCopy160(buffer, testData + (row * HRES)); //for testing without usb
+		RingBuffer_Read(buffer);
+		break;
+	case FB_FORMAT_STREAM_RLE:
+		RingBuffer_ReadRLE(buffer);
+		break;
+	case FB_FORMAT_TEXT:
+		if (entry->src == text_chars) {
+			row = (((row / 8) + fb_scroll_y) % TEXT_ROWS) * 8 + (row % 8);
+		}
+		TEXT_RenderLine(buffer, entry->src + hoffset, row);
+		break;
+	case FB_FORMAT_TILES:
+		TILE_RenderRow(buffer, entry->src + hoffset, row);
+		break;
+	case FB_FORMAT_CALLBACK:
+		if (line_callback) {
+			PROFILE_START();
+			line_callback(buffer, row);
+			PROFILE_END(callback_max);
+		}
+		break;
+	default:
+		if (entry->src == vram) {
+			FB_ExpandRow(buffer, row, hoffset, entry->format);
+		} else {
+			FB_ExpandLine(buffer, entry->src + row * entry->stride + hoffset, entry->format);
+		}
+		break;
+	}
 }
 
 void fastCopy160(uint8_t *dst, const uint8_t *src) {
@@ -57,4 +518,3 @@ void fastCopy160(uint8_t *dst, const uint8_t *src) {
 		*dst32++ = *src32++;
 	}
 }
-
@@ -0,0 +1,110 @@
+/*
+ * VGA_SPI.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#include "VGA_SPI.h"
+#include "VGA.h"
+
+static uint8_t spi_half;                 //lineBuffer half the pixel channel sends next
+static uint16_t spi_top;                 //first scanline showing row 0
+static uint16_t spi_bottom;              //first scanline after the last row
+static uint8_t spi_upscale;              //scanlines per row
+
+// Written into DMA1_Channel3->CCR by the TIM2 CH2 request at the first visible dot
+static const uint32_t spi_dma_start = DMA_CCR_PL | DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TCIE | DMA_CCR_EN;
+
+static void VGA_SPI_PrepareLine(uint8_t *buffer, uint16_t line);
+
+/**
+ * Switch the pixel output from GPIOB to SPI1
+ * Runs from VGA_ApplyMode() at line 0 with the GPIOB line DMA stopped. Rows
+ * are copied into the first SPI_LINE_BYTES of each lineBuffer half.
+ *
+ * @param top: first scanline of the image
+ * @param upscale: scanlines per row
+ */
+void VGA_SPI_Start(uint16_t top, uint8_t upscale) {
+	spi_top = top;
+	spi_upscale = upscale;
+	spi_bottom = top + SPI_VRES * upscale;
+	spi_half = 0;
+
+	// PA7 SPI1 MOSI, alternate function push-pull 50MHz
+	RCC->APB2ENR |= RCC_APB2ENR_SPI1EN;
+	GPIOA->CRL = (GPIOA->CRL & ~(0xFU << 28)) | (0xBU << 28);
+
+	// Transmit-only master (no SCK or MISO pin needed), MSB first, fPCLK2 / 4
+	SPI1->CR1 = 0;
+	SPI1->CR2 = SPI_CR2_TXDMAEN;
+	SPI1->CR1 = SPI_CR1_BIDIMODE | SPI_CR1_BIDIOE | SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI
+			| SPI_CR1_BR_0 | SPI_CR1_SPE;
+
+	// Pixel channel: one line per enable, reloaded by VGA_SPI_IRQHandler
+	DMA1_Channel3->CCR = 0;
+	DMA1_Channel3->CPAR = (uint32_t) &SPI1->DR;
+	DMA1_Channel3->CMAR = (uint32_t) lineBuffer[0];
+	DMA1_Channel3->CNDTR = SPI_LINE_BYTES;
+
+	// Start channel: TIM2 CH2 (same edge that triggers TIM1) enables the pixel
+	// channel, so the line starts without interrupt latency
+	DMA1_Channel7->CCR = 0;
+	DMA1_Channel7->CPAR = (uint32_t) &DMA1_Channel3->CCR;
+	DMA1_Channel7->CMAR = (uint32_t) &spi_dma_start;
+	DMA1_Channel7->CNDTR = 1;
+	DMA1_Channel7->CCR = DMA_CCR_PL | DMA_CCR_CIRC | DMA_CCR_DIR | DMA_CCR_PSIZE_1 | DMA_CCR_MSIZE_1
+			| DMA_CCR_EN;
+	TIM2->DIER |= TIM_DIER_CC2DE;
+
+	HAL_NVIC_SetPriority(DMA1_Channel3_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Channel3_IRQn);
+}
+
+/**
+ * Back to the GPIOB output, PA7 is driven low
+ */
+void VGA_SPI_Stop(void) {
+	TIM2->DIER &= ~TIM_DIER_CC2DE;
+	DMA1_Channel7->CCR = 0;
+	DMA1_Channel3->CCR = 0;
+	HAL_NVIC_DisableIRQ(DMA1_Channel3_IRQn);
+	SPI1->CR1 = 0;
+	GPIOA->BRR = GPIO_PIN_7;
+	GPIOA->CRL = (GPIOA->CRL & ~(0xFU << 28)) | (0x3U << 28);
+}
+
+/**
+ * DMA1_Channel3 transfer complete, the last byte of the line is in the SPI
+ * Points the pixel channel at the other half, which was prepared a line ago,
+ * and refills the half just sent for two lines ahead. A row costs one 50-byte
+ * copy instead of the 160-byte expand of the GPIOB path.
+ */
+void VGA_SPI_IRQHandler(void) {
+	DMA1->IFCR = DMA_IFCR_CGIF3;
+	DMA1_Channel3->CCR = 0;                 // CNDTR only reloads with the channel off
+	uint8_t *sent = lineBuffer[spi_half];
+	spi_half ^= 1;
+	DMA1_Channel3->CMAR = (uint32_t) lineBuffer[spi_half];
+	DMA1_Channel3->CNDTR = SPI_LINE_BYTES;
+	VGA_SPI_PrepareLine(sent, current_line + LINEBUFFERS);
+}
+
+/**
+ * Copy one 1bpp row from vram through the scroll registers
+ *
+ * @param buffer: lineBuffer half
+ * @param line: scanline the buffer will be displayed on
+ */
+static void VGA_SPI_PrepareLine(uint8_t *buffer, uint16_t line) {
+	if (line < spi_top || line >= spi_bottom) {
+		memset(buffer, 0, SPI_ROW_BYTES);
+		return;
+	}
+	uint16_t row = ((line - spi_top) / spi_upscale + fb_scroll_y) % SPI_VRES;
+	const uint8_t *src = vram + row * SPI_ROW_BYTES;
+	uint8_t x = fb_scroll_x % SPI_ROW_BYTES;
+	memcpy(buffer, src + x, SPI_ROW_BYTES - x);
+	memcpy(buffer + SPI_ROW_BYTES - x, src, x);
+}
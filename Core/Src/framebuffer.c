@@ -0,0 +1,643 @@
+/*
+ * framebuffer.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#include "framebuffer.h"
+#include "main.h"
+#include "VGA_SPI.h"
+#include "tilemap.h"
+#include <string.h>
+
+uint8_t vram[VRAM_SIZE];
+uint8_t palette[PALETTE_SIZE];
+volatile FB_Format_t fb_format = FB_FORMAT_STREAM;
+volatile uint16_t fb_scroll_x;
+volatile uint16_t fb_scroll_y;
+volatile uint8_t fb_frame_parity;
+
+// One 4bpp byte to two RGB332 pixels from palette[], first pixel in the low byte
+static uint16_t palette_lut[256];
+static uint8_t palette_upper[PALETTE_SIZE];   // upper FRC level of each entry, palette[] holds the lower
+// One nibble of 2bpp data to two pixels, one nibble of 1bpp data to four pixels.
+// Nibble tables instead of byte tables keep these at 96 bytes of RAM.
+static uint16_t quad_lut[16];
+static uint32_t mono_lut[16];
+
+// Staged rectangle pieces: offset (2 bytes LE), length, bytes. Free running
+// indices, USB writes head and commit, the vertical blank writes tail.
+static uint8_t stage[FB_STAGE_SIZE];
+static uint16_t stage_head;
+static volatile uint16_t stage_commit;
+static volatile uint16_t stage_tail;
+static uint16_t stage_frame;              // commit latched at the frame start, applied before the image
+static uint16_t stage_at;                 // vram offset of the piece being applied
+static uint8_t stage_left;                // bytes of that piece still to copy
+
+// Nibble to a byte mask over four pixels, leftmost pixel (bit 3) in the low byte
+const uint32_t fb_nibble_mask[16] = {
+    0x00000000, 0xFF000000, 0x00FF0000, 0xFFFF0000,
+    0x0000FF00, 0xFF00FF00, 0x00FFFF00, 0xFFFFFF00,
+    0x000000FF, 0xFF0000FF, 0x00FF00FF, 0xFFFF00FF,
+    0x0000FFFF, 0xFF00FFFF, 0x00FFFFFF, 0xFFFFFFFF,
+};
+
+// CGA order, pins are R1-R3 on bits 0-2, G1-G3 on bits 3-5, B1-B2 on bits 6-7
+static void FB_BuildSmallLuts(void);
+static uint8_t FB_Split444(uint8_t r, uint8_t g, uint8_t b, uint8_t upper);
+
+static const uint8_t default_palette[PALETTE_SIZE] = {
+    0x00, 0x80, 0x20, 0xA0, 0x04, 0x84, 0x14, 0xAD,
+    0x52, 0xD2, 0x7A, 0xFA, 0x57, 0xD7, 0x7F, 0xFF,
+};
+
+
+void FB_Init(void) {
+    memset(vram, 0, sizeof(vram));
+    FB_SetPalette(default_palette, 0, PALETTE_SIZE);
+    fb_format = FB_FORMAT_STREAM;
+    FB_SetScroll(0, 0);
+}
+
+
+/**
+ * Select where the scanout takes its rows from
+ * Takes effect on the next source row, resident data in vram is kept.
+ *
+ * @param format: FB_FORMAT_*
+ */
+void FB_SetFormat(FB_Format_t format) {
+    fb_format = format;
+}
+
+
+/**
+ * Set the scroll registers of the resident frame
+ * Moves the start of the picture instead of the data, so scrolling by one
+ * row or column only needs the newly exposed part written. Takes effect on
+ * the next source row.
+ *
+ * @param x: bytes skipped at the start of each row, the skipped part is shown
+ *           at the right. Rounded down to 4 pixels (even bytes) in 4bpp.
+ * @param y: rows skipped at the top, shown again at the bottom. Character
+ *           rows in text mode.
+ */
+void FB_SetScroll(uint16_t x, uint16_t y) {
+    fb_scroll_x = x;
+    fb_scroll_y = y;
+}
+
+
+/**
+ * Change palette entries and rebuild the 2-pixel lookup table
+ *
+ * @param colors: RGB332 values
+ * @param first: first palette index to change
+ * @param count: number of entries, clipped to the palette
+ */
+void FB_SetPalette(const uint8_t *colors, uint8_t first, uint8_t count) {
+    if (first >= PALETTE_SIZE) {
+        return;
+    }
+    if (count > PALETTE_SIZE - first) {
+        count = PALETTE_SIZE - first;
+    }
+    memcpy(&palette[first], colors, count);
+    memcpy(&palette_upper[first], colors, count);   // one level, FB_FORMAT_FRC shows them solid
+
+    for (uint16_t i = 0; i < 256; i++) {
+        palette_lut[i] = palette[i >> 4] | (palette[i & 0x0F] << 8);
+    }
+    FB_BuildSmallLuts();
+}
+
+
+/**
+ * Load RGB444 palette entries for FB_FORMAT_FRC
+ * Every channel is split into the two nearest RGB332 levels. The FRC expand
+ * alternates them between neighbouring pixels, lines and frames, so each
+ * pixel averages to the in-between level. palette[] and the tables of the
+ * other formats get the lower level only.
+ *
+ * @param colors: two bytes per entry, 0x0R then 0xGB
+ * @param first: first palette index to change
+ * @param count: number of entries, clipped to the palette
+ */
+void FB_SetPalette444(const uint8_t *colors, uint8_t first, uint8_t count) {
+    if (first >= PALETTE_SIZE) {
+        return;
+    }
+    if (count > PALETTE_SIZE - first) {
+        count = PALETTE_SIZE - first;
+    }
+    for (uint8_t i = first; i < first + count; i++, colors += 2) {
+        uint8_t r = colors[0] & 0x0F, g = colors[1] >> 4, b = colors[1] & 0x0F;
+        palette[i] = FB_Split444(r, g, b, 0);
+        palette_upper[i] = FB_Split444(r, g, b, 1);
+    }
+
+    for (uint16_t i = 0; i < 256; i++) {
+        palette_lut[i] = palette[i >> 4] | (palette[i & 0x0F] << 8);
+    }
+    FB_BuildSmallLuts();
+}
+
+
+/**
+ * One of the two RGB332 levels an RGB444 color falls between
+ * Channels are rounded to half steps of the 3/3/2 bit levels, an odd half
+ * step gets the next level up as its upper value.
+ *
+ * @param upper: 0 for the lower, 1 for the upper level
+ */
+static uint8_t FB_Split444(uint8_t r, uint8_t g, uint8_t b, uint8_t upper) {
+    uint8_t hr = (r * 14 + 7) / 15;
+    uint8_t hg = (g * 14 + 7) / 15;
+    uint8_t hb = (b * 6 + 7) / 15;
+    if (upper) {
+        hr++;
+        hg++;
+        hb++;
+    }
+    return (hr >> 1) | ((hg >> 1) << 3) | ((hb >> 1) << 6);
+}
+
+
+/**
+ * 2bpp and 1bpp tables from palette[]
+ */
+static void FB_BuildSmallLuts(void) {
+    for (uint8_t i = 0; i < 16; i++) {
+        quad_lut[i] = palette[i >> 2] | (palette[i & 0x03] << 8);
+        mono_lut[i] = 0;
+        for (uint8_t bit = 0; bit < 4; bit++) {
+            uint8_t color = palette[(i >> (3 - bit)) & 1];
+            mono_lut[i] |= (uint32_t) color << (bit * 8);
+        }
+    }
+}
+
+
+/**
+ * Change one palette entry, patching only the lookup entries that use it
+ * About 150 cycles instead of the full rebuild, cheap enough for the copper
+ * list in the HSYNC interrupt. An entry split into two FRC levels by
+ * FB_SetPalette444() only gets a new lower level and keeps its upper one,
+ * a single-level entry changes as a whole.
+ *
+ * @param index: palette index, 0 to PALETTE_SIZE-1
+ * @param color: RGB332 value
+ */
+void FB_SetPaletteEntry(uint8_t index, uint8_t color) {
+    if (index >= PALETTE_SIZE) {
+        return;
+    }
+    if (palette_upper[index] == palette[index]) {
+        palette_upper[index] = color;
+    }
+    palette[index] = color;
+
+    uint8_t *lut = (uint8_t*) palette_lut;    // little endian, first pixel in the low byte
+    for (uint8_t i = 0; i < 16; i++) {
+        lut[((index << 4) | i) * 2] = color;
+        lut[((i << 4) | index) * 2 + 1] = color;
+    }
+    if (index < 4) {
+        uint8_t *quad = (uint8_t*) quad_lut;
+        for (uint8_t i = 0; i < 4; i++) {
+            quad[((index << 2) | i) * 2] = color;
+            quad[((i << 2) | index) * 2 + 1] = color;
+        }
+    }
+    if (index < 2) {
+        uint8_t *mono = (uint8_t*) mono_lut;
+        for (uint8_t i = 0; i < 16; i++) {
+            for (uint8_t bit = 0; bit < 4; bit++) {
+                if (((i >> (3 - bit)) & 1) == index) {
+                    mono[i * 4 + bit] = color;
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * Copy received data into vram
+ *
+ * @param pos: byte offset into the frame, wraps at VRAM_SIZE
+ * @param data: packed pixel data
+ * @param len: number of bytes
+ */
+void FB_Write(uint16_t pos, const uint8_t *data, uint16_t len) {
+    pos %= VRAM_SIZE;
+    if (len > VRAM_SIZE - pos) {
+        uint16_t space_left = VRAM_SIZE - pos;
+        memcpy(&vram[pos], data, space_left); //copy to end
+        memcpy(vram, &data[space_left], len - space_left); //remaining after wrap
+    } else {
+        memcpy(&vram[pos], data, len);
+    }
+}
+
+
+/**
+ * Set cell colors of FB_FORMAT_ATTR
+ * Packet is groups of column, row, foreground, background, so recoloring a
+ * cell costs four bytes.
+ *
+ * @param data: packet
+ * @param len: packet length
+ */
+void FB_SetAttributes(const uint8_t *data, uint16_t len) {
+    for (; len >= 4; len -= 4, data += 4) {
+        if (data[0] < ATTR_COLS && data[1] < ATTR_ROWS) {
+            uint8_t *cell = &vram[ATTR_BASE + (data[1] * ATTR_COLS + data[0]) * 2];
+            cell[0] = data[2];
+            cell[1] = data[3];
+        }
+    }
+}
+
+
+/**
+ * Copy a column of received data into vram
+ * Each width bytes of data go to the next row, for the column a horizontal
+ * scroll exposes. Rows are as long as in the current format.
+ *
+ * @param pos: byte offset of the first row
+ * @param data: packed pixel data, whole rows of width bytes
+ * @param len: number of bytes
+ * @param width: bytes per row
+ */
+void FB_WriteColumn(uint16_t pos, const uint8_t *data, uint16_t len, uint8_t width) {
+    uint16_t stride = FB_RowBytes(fb_format);
+    if (stride == 0 || width == 0) {
+        return;
+    }
+    for (; len >= width; len -= width, data += width) {
+        FB_Write(pos, data, width);
+        pos = (pos + stride) % VRAM_SIZE;
+    }
+}
+
+
+/**
+ * Copy part of a rectangle into vram, or stage it for the vertical blank
+ * Data arrives in packets that do not end on row boundaries, so the caller
+ * passes how much of the rectangle is already written. Rows are as long as
+ * in the current format, tile map rows are TILEMAP_COLS entries; bytes past
+ * the end of a vram row are clipped instead of spilling into the next one.
+ * Staged pieces only show once FB_CommitStaged() is called, all together in
+ * the blank lines before the next frame's image. A piece written at once
+ * while older pieces still wait in the stage is staged behind them, so they
+ * cannot overwrite it later. A piece that does not fit the stage is dropped;
+ * the caller should then drop the whole rectangle with FB_DiscardStaged().
+ *
+ * @param pos: byte offset of the top left corner
+ * @param done: bytes of the rectangle written by earlier calls
+ * @param data: packed pixel data, rows of width bytes
+ * @param len: number of bytes
+ * @param width: bytes per rectangle row
+ * @param at_vblank: stage instead of writing, tear free
+ * @retval false when a piece did not fit the stage
+ */
+bool FB_WriteRect(uint16_t pos, uint16_t done, const uint8_t *data, uint16_t len, uint8_t width, bool at_vblank) {
+    uint16_t stride = (fb_format == FB_FORMAT_TILES) ? TILEMAP_COLS : FB_RowBytes(fb_format);
+    if (stride == 0 || width == 0) {
+        return true;
+    }
+    uint16_t keep = stride - pos % stride;       // bytes of a rectangle row left in the vram row
+    bool placed = true;
+    while (len) {
+        uint8_t column = done % width;
+        uint16_t n = width - column;
+        if (n > len) {
+            n = len;
+        }
+        uint16_t visible = (column < keep) ? keep - column : 0;
+        if (visible > n) {
+            visible = n;
+        }
+        uint16_t at = (pos + (done / width) * stride + column) % VRAM_SIZE;
+
+        if (visible == 0) {
+            // past the end of the vram row
+        } else if (!at_vblank && stage_head == stage_tail) {
+            FB_Write(at, data, visible);
+        } else if ((uint16_t) (stage_head - stage_tail) + 3 + visible <= FB_STAGE_SIZE) {
+            stage[stage_head++ % FB_STAGE_SIZE] = at & 0xFF;
+            stage[stage_head++ % FB_STAGE_SIZE] = at >> 8;
+            stage[stage_head++ % FB_STAGE_SIZE] = visible;
+            for (uint16_t i = 0; i < visible; i++) {
+                stage[stage_head++ % FB_STAGE_SIZE] = data[i];
+            }
+        } else {
+            placed = false;
+        }
+        data += n;
+        len -= n;
+        done += n;
+    }
+    return placed;
+}
+
+
+/**
+ * Drop staged pieces that were not committed yet
+ * Call when a rectangle is abandoned, so its pieces do not show with the next
+ * rectangle's commit.
+ */
+void FB_DiscardStaged(void) {
+    stage_head = stage_commit;
+}
+
+
+/**
+ * Release everything staged so far to the next frame start
+ * Call once a rectangle is complete, so it never shows half written.
+ */
+void FB_CommitStaged(void) {
+    __DMB();
+    stage_commit = stage_head;
+}
+
+
+/**
+ * Pick the pieces FB_ApplyStaged() writes this frame
+ * Called by VGA at the start of the frame. Pieces committed later wait for
+ * the next frame, so a rectangle never shows half applied.
+ */
+void FB_LatchStaged(void) {
+    stage_frame = stage_commit;
+}
+
+
+/**
+ * Write part of the latched rectangle pieces into vram
+ * Called by VGA on the blank lines between vertical sync and the image, at
+ * most max_bytes per line, so a line never pays for the whole stage. A piece
+ * may be split across lines; copies are split at the stage and vram wraps
+ * instead of wrapping every byte.
+ *
+ * @param max_bytes: pixel bytes to copy at most
+ */
+void FB_ApplyStaged(uint16_t max_bytes) {
+    uint16_t tail = stage_tail;
+    uint16_t end = stage_frame;
+    __DMB();
+    while (max_bytes) {
+        if (stage_left == 0) {
+            if (tail == end) {
+                break;
+            }
+            stage_at = stage[tail++ % FB_STAGE_SIZE];
+            stage_at |= stage[tail++ % FB_STAGE_SIZE] << 8;
+            stage_left = stage[tail++ % FB_STAGE_SIZE];
+            continue;
+        }
+        uint16_t n = stage_left;
+        if (n > max_bytes) {
+            n = max_bytes;
+        }
+        if (n > FB_STAGE_SIZE - tail % FB_STAGE_SIZE) {
+            n = FB_STAGE_SIZE - tail % FB_STAGE_SIZE;
+        }
+        if (n > VRAM_SIZE - stage_at) {
+            n = VRAM_SIZE - stage_at;
+        }
+        memcpy(&vram[stage_at], &stage[tail % FB_STAGE_SIZE], n);
+        tail += n;
+        stage_at += n;
+        if (stage_at == VRAM_SIZE) {
+            stage_at = 0;
+        }
+        stage_left -= n;
+        max_bytes -= n;
+    }
+    __DMB();
+    stage_tail = tail;
+}
+
+
+/**
+ * Bytes in one HRES-pixel row of a bitmap format
+ *
+ * @param format: FB_FORMAT_*
+ * @return row length in vram, 0 for formats that are not bitmaps
+ */
+uint16_t FB_RowBytes(FB_Format_t format) {
+    switch (format) {
+    case FB_FORMAT_4BPP:
+    case FB_FORMAT_FRC:
+        return HRES / 2;
+    case FB_FORMAT_2BPP:
+        return HRES / 4;
+    case FB_FORMAT_1BPP:
+    case FB_FORMAT_ATTR:
+        return HRES / 8;
+    case FB_FORMAT_HIRES:
+        return SPI_ROW_BYTES;
+    default:
+        return 0;
+    }
+}
+
+
+/**
+ * Expand one row of packed pixels
+ *
+ * @param dst: line buffer (HRES bytes)
+ * @param src: first byte of the row
+ * @param format: bitmap format of src, other formats are ignored
+ */
+void FB_ExpandLine(uint8_t *dst, const uint8_t *src, FB_Format_t format) {
+    uint16_t len = FB_RowBytes(format);
+    switch (format) {
+    case FB_FORMAT_4BPP:
+        FB_Expand4bpp(dst, src, len);
+        break;
+    case FB_FORMAT_2BPP:
+        FB_Expand2bpp(dst, src, len);
+        break;
+    case FB_FORMAT_1BPP:
+        FB_Expand1bpp(dst, src, len);
+        break;
+    default:
+        break;
+    }
+}
+
+
+/**
+ * Expand a row of the resident frame through the scroll registers
+ * A horizontally scrolled row is expanded in two spans, the part after the
+ * offset and then the wrapped start of the row.
+ *
+ * @param dst: line buffer (HRES bytes)
+ * @param row: source row on screen, 0 to VRES-1
+ * @param hoffset: bytes added to fb_scroll_x
+ * @param format: bitmap format of vram
+ */
+void FB_ExpandRow(uint8_t *dst, uint16_t row, uint16_t hoffset, FB_Format_t format) {
+    if (format == FB_FORMAT_RLE) {
+        FB_ExpandRLE(dst, (row + fb_scroll_y) % VRES);  // rows have no fixed length, no horizontal scroll
+        return;
+    }
+    uint16_t len = FB_RowBytes(format);
+    if (len == 0) {
+        return;
+    }
+    row = (row + fb_scroll_y) % VRES;
+    const uint8_t *src = vram + row * len;
+    uint16_t x = (fb_scroll_x + hoffset) % len;
+    if (format == FB_FORMAT_4BPP || format == FB_FORMAT_FRC) {
+        x &= ~1; // whole 32-bit stores, also keeps the FRC pixel phase
+    }
+    uint8_t *wrap = dst + (len - x) * (HRES / len);
+
+    switch (format) {
+    case FB_FORMAT_4BPP:
+        FB_Expand4bpp(dst, src + x, len - x);
+        FB_Expand4bpp(wrap, src, x);
+        break;
+    case FB_FORMAT_2BPP:
+        FB_Expand2bpp(dst, src + x, len - x);
+        FB_Expand2bpp(wrap, src, x);
+        break;
+    case FB_FORMAT_1BPP:
+        FB_Expand1bpp(dst, src + x, len - x);
+        FB_Expand1bpp(wrap, src, x);
+        break;
+    case FB_FORMAT_FRC: {
+        uint8_t phase = (row + fb_frame_parity) & 1;
+        FB_Expand4bppFRC(dst, src + x, len - x, phase);
+        FB_Expand4bppFRC(wrap, src, x, phase);
+        break;
+    }
+    case FB_FORMAT_ATTR: {
+        const uint8_t *attrs = vram + ATTR_BASE + (row / ATTR_CELL) * ATTR_COLS * 2;
+        FB_ExpandAttr(dst, src + x, attrs + x * 2, len - x);
+        FB_ExpandAttr(wrap, src, attrs, x);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+
+/**
+ * Expand 4bpp source bytes into RGB332 pixels
+ * Two LUT lookups per 32-bit store, 40 iterations for a full row.
+ *
+ * @param dst: line buffer, word aligned
+ * @param src: packed bytes, HRES / 2 for a full row
+ * @param len: number of source bytes, even
+ */
+void FB_Expand4bpp(uint8_t *dst, const uint8_t *src, uint16_t len) {
+    uint32_t *dst32 = (uint32_t*) dst;
+    for (int i = 0; i < len / 2; i++) {
+        *dst32++ = palette_lut[src[0]] | ((uint32_t) palette_lut[src[1]] << 16);
+        src += 2;
+    }
+}
+
+
+/**
+ * Expand 4bpp source bytes with the FRC phase of this line and frame
+ * Phase 0 shows the first pixel of each byte at the lower and the second at
+ * the upper level, phase 1 the other way round. Levels come from palette[]
+ * and palette_upper[] rather than the 4bpp table, so a copper change through
+ * FB_SetPaletteEntry() cannot lose the upper level. Four byte lookups per
+ * 32-bit store, about twice the plain 4bpp expand.
+ *
+ * @param dst: line buffer, word aligned
+ * @param src: packed bytes
+ * @param len: number of source bytes, even
+ * @param phase: (row + fb_frame_parity) & 1
+ */
+void FB_Expand4bppFRC(uint8_t *dst, const uint8_t *src, uint16_t len, uint8_t phase) {
+    const uint8_t *first = phase ? palette_upper : palette;
+    const uint8_t *second = phase ? palette : palette_upper;
+    uint32_t *dst32 = (uint32_t*) dst;
+    for (int i = 0; i < len / 2; i++) {
+        uint8_t b0 = src[0], b1 = src[1];
+        *dst32++ = first[b0 >> 4] | (second[b0 & 0x0F] << 8) | (first[b1 >> 4] << 16)
+                | ((uint32_t) second[b1 & 0x0F] << 24);
+        src += 2;
+    }
+}
+
+
+/**
+ * Expand 2bpp source bytes into RGB332 pixels
+ *
+ * @param dst: line buffer, word aligned
+ * @param src: packed bytes, HRES / 4 for a full row
+ * @param len: number of source bytes
+ */
+void FB_Expand2bpp(uint8_t *dst, const uint8_t *src, uint16_t len) {
+    uint32_t *dst32 = (uint32_t*) dst;
+    for (int i = 0; i < len; i++) {
+        uint8_t b = *src++;
+        *dst32++ = quad_lut[b >> 4] | ((uint32_t) quad_lut[b & 0x0F] << 16);
+    }
+}
+
+
+/**
+ * Expand 1bpp source bytes through per-cell colors
+ * One source byte is one cell wide, so each byte takes the next color pair.
+ *
+ * @param dst: line buffer, word aligned
+ * @param src: packed bytes, MSB first
+ * @param attrs: foreground, background RGB332 pair for each source byte
+ * @param len: number of source bytes
+ */
+void FB_ExpandAttr(uint8_t *dst, const uint8_t *src, const uint8_t *attrs, uint16_t len) {
+    uint32_t *dst32 = (uint32_t*) dst;
+    for (int i = 0; i < len; i++) {
+        uint8_t b = *src++;
+        uint32_t bg = attrs[1] * 0x01010101u;
+        uint32_t diff = (attrs[0] * 0x01010101u) ^ bg;
+        attrs += 2;
+        *dst32++ = bg ^ (diff & fb_nibble_mask[b >> 4]);
+        *dst32++ = bg ^ (diff & fb_nibble_mask[b & 0x0F]);
+    }
+}
+
+
+/**
+ * Expand 1bpp source bytes into RGB332 pixels
+ *
+ * @param dst: line buffer, word aligned
+ * @param src: packed bytes, HRES / 8 for a full row
+ * @param len: number of source bytes
+ */
+void FB_Expand1bpp(uint8_t *dst, const uint8_t *src, uint16_t len) {
+    uint32_t *dst32 = (uint32_t*) dst;
+    for (int i = 0; i < len; i++) {
+        uint8_t b = *src++;
+        *dst32++ = mono_lut[b >> 4];
+        *dst32++ = mono_lut[b & 0x0F];
+    }
+}
+
+
+/**
+ * Decode a row of FB_FORMAT_RLE
+ * Bad data costs a wrong row but never the line deadline, see RLE_DecodeLine().
+ *
+ * @param dst: line buffer (HRES bytes)
+ * @param row: source row, 0 to VRES-1
+ */
+void FB_ExpandRLE(uint8_t *dst, uint16_t row) {
+    uint16_t pos = vram[row * 2] | (vram[row * 2 + 1] << 8);
+    if (pos >= VRAM_SIZE) {
+        pos = VRAM_SIZE;
+    }
+    RLE_DecodeLine(dst, HRES, &vram[pos], VRAM_SIZE - pos);
+}
@@ -0,0 +1,215 @@
+/*
+ * lz.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#include "lz.h"
+#include <string.h>
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/**
+ * Start a new stream
+ *
+ * @param lz: decoder
+ * @param window: circular output buffer
+ * @param size: window bytes
+ * @param pos: where the first output byte goes
+ */
+void LZ_Reset(LZ_Decoder_t *lz, uint8_t *window, uint16_t size, uint16_t pos) {
+    lz->window = window;
+    lz->size = size;
+    lz->pos = pos;
+    lz->state = LZ_TOKEN;
+    lz->literal = 0;
+    lz->match = 0;
+    lz->offset = 0;
+}
+
+
+/**
+ * Copy a match, in spans that neither wrap nor overlap their source
+ * An offset of 1 is a run of one byte and done with memset.
+ */
+static void LZ_CopyMatch(LZ_Decoder_t *lz, uint16_t *room) {
+    while (lz->match && *room) {
+        uint16_t from = (lz->pos >= lz->offset) ? lz->pos - lz->offset : lz->pos + lz->size - lz->offset;
+        uint16_t n = MIN(MIN(lz->match, *room), MIN(lz->size - lz->pos, lz->size - from));
+        if (lz->offset == 1) {
+            memset(&lz->window[lz->pos], lz->window[from], n);
+        } else {
+            n = MIN(n, lz->offset);
+            memcpy(&lz->window[lz->pos], &lz->window[from], n);
+        }
+        lz->pos = (lz->pos + n == lz->size) ? 0 : lz->pos + n;
+        lz->match -= n;
+        *room -= n;
+    }
+}
+
+
+/**
+ * Decode as much as input and output room allow
+ * Output is limited to *room bytes from the window position on, so the
+ * caller can hand out only what its consumer has released. A bad offset
+ * drops its match instead of reading outside the window.
+ *
+ * @param lz: decoder
+ * @param src: input
+ * @param len: input bytes
+ * @param room: output bytes allowed, decremented by what was written
+ * @retval input bytes used; less than len only when room ran out
+ */
+uint16_t LZ_Decode(LZ_Decoder_t *lz, const uint8_t *src, uint16_t len, uint16_t *room) {
+    uint16_t in = 0;
+
+    for (;;) {
+        switch (lz->state) {
+        case LZ_TOKEN:
+            if (in == len) {
+                return in;
+            }
+            lz->literal = src[in] >> 4;
+            lz->match = (src[in] & 0x0F) + LZ_MATCH_MIN;
+            in++;
+            lz->state = (lz->literal == 15) ? LZ_LITERAL_LENGTH : LZ_LITERALS;
+            break;
+        case LZ_LITERAL_LENGTH:
+            if (in == len) {
+                return in;
+            }
+            lz->literal += src[in];
+            if (src[in++] != 255) {
+                lz->state = LZ_LITERALS;
+            }
+            break;
+        case LZ_LITERALS:
+            while (lz->literal && in < len && *room) {
+                uint16_t n = MIN(MIN(lz->literal, len - in), MIN(*room, lz->size - lz->pos));
+                memcpy(&lz->window[lz->pos], &src[in], n);
+                lz->pos = (lz->pos + n == lz->size) ? 0 : lz->pos + n;
+                lz->literal -= n;
+                *room -= n;
+                in += n;
+            }
+            if (lz->literal) {
+                return in;
+            }
+            lz->state = LZ_OFFSET_LOW;
+            break;
+        case LZ_OFFSET_LOW:
+            if (in == len) {
+                return in;
+            }
+            lz->offset = src[in++];
+            lz->state = LZ_OFFSET_HIGH;
+            break;
+        case LZ_OFFSET_HIGH:
+            if (in == len) {
+                return in;
+            }
+            lz->offset |= src[in++] << 8;
+            lz->state = (lz->match == 15 + LZ_MATCH_MIN) ? LZ_MATCH_LENGTH : LZ_MATCH;
+            break;
+        case LZ_MATCH_LENGTH:
+            if (in == len) {
+                return in;
+            }
+            lz->match += src[in];
+            if (src[in++] != 255) {
+                lz->state = LZ_MATCH;
+            }
+            break;
+        case LZ_MATCH:
+            if (lz->offset == 0 || lz->offset >= lz->size) {
+                lz->match = 0;
+            }
+            LZ_CopyMatch(lz, room);
+            if (lz->match) {
+                return in;
+            }
+            lz->state = LZ_TOKEN;
+            break;
+        default:
+            lz->state = LZ_TOKEN;
+            break;
+        }
+    }
+}
+
+
+static uint8_t* LZ_Length(uint8_t *dst, uint32_t len) {
+    for (; len >= 255; len -= 255) {
+        *dst++ = 255;
+    }
+    *dst++ = len;
+    return dst;
+}
+
+
+static uint32_t LZ_Hash(const uint8_t *p) {
+    uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+    return (v * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+
+/**
+ * Encode one stream, for the host
+ * Greedy single-probe match search. Offsets stay below window, the size of
+ * the decoder's circular output. The stream ends with a literal-only
+ * sequence; the decoder then waits for an offset until it is reset.
+ *
+ * @param dst: output, LZ_BOUND(len) bytes
+ * @param src: data
+ * @param len: data bytes, a frame; decoder lengths are 16 bit
+ * @param window: decoder window, offsets are below this
+ * @param table: LZ_HASH_SIZE entries of scratch
+ * @retval bytes written
+ */
+uint32_t LZ_Encode(uint8_t *dst, const uint8_t *src, uint32_t len, uint16_t window, uint32_t *table) {
+    uint8_t *out = dst;
+    uint32_t anchor = 0;
+    uint32_t i = 0;
+
+    memset(table, 0xFF, LZ_HASH_SIZE * sizeof(uint32_t));
+    while (i + LZ_MATCH_MIN <= len) {
+        uint32_t h = LZ_Hash(&src[i]);
+        uint32_t candidate = table[h];
+        table[h] = i;
+        if (candidate == 0xFFFFFFFF || i - candidate >= window || memcmp(&src[candidate], &src[i], LZ_MATCH_MIN)) {
+            i++;
+            continue;
+        }
+        uint32_t match = LZ_MATCH_MIN;
+        while (i + match < len && src[candidate + match] == src[i + match]) {
+            match++;
+        }
+
+        uint32_t literal = i - anchor;
+        uint8_t *token = out++;
+        *token = (MIN(literal, 15) << 4) | MIN(match - LZ_MATCH_MIN, 15);
+        if (literal >= 15) {
+            out = LZ_Length(out, literal - 15);
+        }
+        memcpy(out, &src[anchor], literal);
+        out += literal;
+        *out++ = (i - candidate) & 0xFF;
+        *out++ = (i - candidate) >> 8;
+        if (match - LZ_MATCH_MIN >= 15) {
+            out = LZ_Length(out, match - LZ_MATCH_MIN - 15);
+        }
+        i += match;
+        anchor = i;
+    }
+
+    uint32_t literal = len - anchor;
+    *out++ = MIN(literal, 15) << 4;
+    if (literal >= 15) {
+        out = LZ_Length(out, literal - 15);
+    }
+    memcpy(out, &src[anchor], literal);
+    out += literal;
+    return out - dst;
+}
@@ -0,0 +1,116 @@
+/*
+ * rle.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#include "rle.h"
+#include <string.h>
+
+/**
+ * Emit pixels as literal runs
+ *
+ * @retval bytes written
+ */
+static uint16_t RLE_Literal(uint8_t *dst, const uint8_t *src, uint16_t len, uint16_t *runs) {
+    uint16_t out = 0;
+    while (len) {
+        uint16_t n = (len > RLE_LITERAL_MAX) ? RLE_LITERAL_MAX : len;
+        dst[out++] = n - 1;
+        memcpy(&dst[out], src, n);
+        out += n;
+        src += n;
+        len -= n;
+        (*runs)++;
+    }
+    return out;
+}
+
+
+/**
+ * Encode one line
+ * Greedy: equal pixels from RLE_REPEAT_MIN on become a repeat run, everything
+ * else is collected into literal runs. A line that needs more than
+ * RLE_MAX_RUNS controls is sent as a literal line instead, which keeps the
+ * decoder inside its bound at a cost of at most 2 bytes over the raw line.
+ *
+ * @param dst: output, RLE_LINE_MAX(width) bytes
+ * @param src: RGB332 pixels
+ * @param width: pixels in the line
+ * @retval bytes written
+ */
+uint16_t RLE_EncodeLine(uint8_t *dst, const uint8_t *src, uint16_t width) {
+    uint16_t out = 0;
+    uint16_t runs = 0;
+    uint16_t literal = 0;             // start of the pending literal pixels
+    uint16_t x = 0;
+
+    while (x < width) {
+        uint16_t n = 1;
+        while (x + n < width && n < RLE_REPEAT_MAX && src[x + n] == src[x]) {
+            n++;
+        }
+        if (n >= RLE_REPEAT_MIN) {
+            out += RLE_Literal(&dst[out], &src[literal], x - literal, &runs);
+            dst[out++] = n - RLE_REPEAT_MIN + RLE_LITERAL_MAX;
+            dst[out++] = src[x];
+            runs++;
+            literal = x + n;
+        }
+        x += n;
+        if (runs > RLE_MAX_RUNS) {
+            break;
+        }
+    }
+    out += RLE_Literal(&dst[out], &src[literal], x - literal, &runs);
+
+    if (runs > RLE_MAX_RUNS) {
+        runs = 0;
+        out = RLE_Literal(dst, src, width, &runs);
+    }
+    return out;
+}
+
+
+/**
+ * Decode one line
+ * Follows at most RLE_MAX_RUNS controls and never reads past size or writes
+ * past width, so the cost is bounded by the controls plus width bytes of
+ * copies whatever the input. Pixels the line does not cover are black.
+ *
+ * @param dst: output, width pixels
+ * @param width: pixels in the line
+ * @param src: coded line
+ * @param size: bytes available at src
+ * @retval coded bytes used
+ */
+uint16_t RLE_DecodeLine(uint8_t *dst, uint16_t width, const uint8_t *src, uint16_t size) {
+    uint16_t pos = 0;
+    uint16_t x = 0;
+
+    for (uint8_t runs = 0; runs < RLE_MAX_RUNS && x < width && pos + 1 < size; runs++) {
+        uint8_t control = src[pos++];
+        uint16_t n;
+        if (control < RLE_LITERAL_MAX) {
+            n = control + 1;
+            if (n > size - pos) {
+                n = size - pos;
+            }
+            if (n > width - x) {
+                n = width - x;
+            }
+            memcpy(&dst[x], &src[pos], n);
+            pos += n;
+        } else {
+            n = control - RLE_LITERAL_MAX + RLE_REPEAT_MIN;
+            if (n > width - x) {
+                n = width - x;
+            }
+            memset(&dst[x], src[pos++], n);
+        }
+        x += n;
+    }
+    memset(&dst[x], 0, width - x);
+    return pos;
+}
@@ -0,0 +1,88 @@
+/*
+ * textmode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#include "textmode.h"
+#include "font4x8.h"
+#include <string.h>
+
+/**
+ * Fill the screen with spaces
+ *
+ * @param attr: attribute for every cell
+ */
+void TEXT_Clear(uint8_t attr) {
+    memset(text_chars, ' ', TEXT_CELLS);
+    memset(text_attrs, attr, TEXT_CELLS);
+}
+
+
+/**
+ * Place a string at a cell, continuing on the next row at the right edge
+ * Stops at the end of the screen.
+ *
+ * @param col: first column, 0 to TEXT_COLS-1
+ * @param row: row, 0 to TEXT_ROWS-1
+ * @param attr: attribute for the written cells
+ * @param str: zero terminated ASCII
+ */
+void TEXT_Print(uint8_t col, uint8_t row, uint8_t attr, const char *str) {
+    uint16_t pos = row * TEXT_COLS + col;
+    while (*str && pos < TEXT_CELLS) {
+        text_chars[pos] = *str++;
+        text_attrs[pos] = attr;
+        pos++;
+    }
+}
+
+
+/**
+ * Text update received over USB
+ * Packet is column, row, attribute and then the characters, so changing one
+ * character costs four bytes.
+ *
+ * @param data: packet
+ * @param len: packet length, at least 4
+ */
+void TEXT_Write(const uint8_t *data, uint16_t len) {
+    if (len < 4 || data[0] >= TEXT_COLS || data[1] >= TEXT_ROWS) {
+        return;
+    }
+    uint16_t pos = data[1] * TEXT_COLS + data[0];
+    uint16_t count = len - 3;
+    if (count > TEXT_CELLS - pos) {
+        count = TEXT_CELLS - pos;
+    }
+    memcpy(&text_chars[pos], &data[3], count);
+    memset(&text_attrs[pos], data[2], count);
+}
+
+
+/**
+ * Render one glyph row of the text screen into HRES RGB332 pixels
+ * One font lookup and one 32-bit store per cell, 40 iterations per line.
+ *
+ * @param dst: line buffer (HRES bytes)
+ * @param chars: cell of the top left character, normally text_chars
+ * @param line: glyph row counted from chars
+ */
+void TEXT_RenderLine(uint8_t *dst, const uint8_t *chars, uint16_t line) {
+    uint32_t *dst32 = (uint32_t*) dst;
+    uint8_t y = line % FONT_HEIGHT;
+    chars += (line / FONT_HEIGHT) * TEXT_COLS;
+    const uint8_t *attrs = chars + TEXT_CELLS;
+
+    for (int i = 0; i < TEXT_COLS; i++) {
+        uint8_t c = chars[i] - FONT_FIRST;
+        if (c >= FONT_GLYPHS) {
+            c = 0; // control and 8-bit codes show as space
+        }
+        uint8_t a = attrs[i];
+        uint32_t fg = palette[a & 0x0F] * 0x01010101u;
+        uint32_t bg = palette[a >> 4] * 0x01010101u;
+        *dst32++ = bg ^ ((fg ^ bg) & fb_nibble_mask[font4x8[c][y]]);
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * tilemap.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#include "tilemap.h"
+#include "main.h"
+#include "tileset.h"
+
+Sprite_t sprites[SPRITE_COUNT];
+
+
+void TILE_Init(void) {
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        sprites[i].tile = SPRITE_HIDDEN;
+    }
+}
+
+
+/**
+ * Sprite update received over USB
+ * Packet is groups of index, x, y, tile, so moving a sprite costs four bytes.
+ * Takes effect on the next source row, a sprite can tear for one frame.
+ *
+ * @param data: packet
+ * @param len: packet length
+ */
+void TILE_SetSprites(const uint8_t *data, uint16_t len) {
+    for (; len >= 4; len -= 4, data += 4) {
+        if (data[0] < SPRITE_COUNT) {
+            Sprite_t *sprite = &sprites[data[0]];
+            sprite->x = data[1];
+            sprite->y = data[2];
+            sprite->tile = data[3];
+        }
+    }
+}
+
+
+/**
+ * Render one source row of the tilemap with sprites on top
+ * Tiles are two word copies each (20 per row), every visible sprite adds one
+ * 8-pixel color-key loop. Worst case with all sprites on the same row is
+ * roughly 700 cycles, well inside one 640x480 line (2400 cycles); the measured
+ * figure is VGA_GetProfile()->line_max.
+ *
+ * @param dst: line buffer (HRES bytes)
+ * @param map: top left cell, normally tilemap
+ * @param row: pixel row counted from map, sprite y is relative to it as well
+ */
+void TILE_RenderRow(uint8_t *dst, const uint8_t *map, uint16_t row) {
+    uint32_t *dst32 = (uint32_t*) dst;
+    uint8_t ty = row % TILE_SIZE;
+    map += (row / TILE_SIZE) * TILEMAP_COLS;
+
+    for (int i = 0; i < TILEMAP_COLS; i++) {
+        uint8_t t = map[i];
+        if (t >= TILE_COUNT) {
+            t = 0;
+        }
+        const uint32_t *src32 = (const uint32_t*) &tiles[t][ty * TILE_SIZE];
+        *dst32++ = src32[0];
+        *dst32++ = src32[1];
+    }
+
+    // Lowest index drawn last, so it ends up on top
+    for (int s = SPRITE_COUNT - 1; s >= 0; s--) {
+        const Sprite_t *sprite = &sprites[s];
+        uint16_t sy = row + TILE_SIZE - sprite->y;
+        if (sprite->tile >= TILE_COUNT || sy >= TILE_SIZE) {
+            continue;
+        }
+        const uint8_t *src = &tiles[sprite->tile][sy * TILE_SIZE];
+        int16_t x = sprite->x - TILE_SIZE;
+        for (int i = 0; i < TILE_SIZE; i++, x++) {
+            if (src[i] != TILE_KEY && (uint16_t) x < HRES) {
+                dst[x] = src[i];
+            }
+        }
+    }
+}
@@ -8,13 +8,24 @@
 
 
 #include "usb_frame_buffer.h"
+#include "framebuffer.h"
+#include "textmode.h"
+#include "tilemap.h"
 #include "usbd_cdc_if.h"
+#include "usbd_vga_if.h"
 #include <string.h>
 
 // Global instances
-RingBuffer_t ring_buffer;
+RingBuffer_t ring_buffer __ALIGNED(4);
 FrameManager_t frame_manager;
 
+// FB_FORMAT_STREAM_LZ: decoder writing into the ring, and the part of the
+// last packet it had no room for yet. The packet stays in the USB receive
+// buffer until it is used up.
+static LZ_Decoder_t lz;
+static const uint8_t *lz_input;
+static volatile uint16_t lz_left;
+
 
 void USB_FrameBuffer_Init(void) {
     // Clear ring buffer
@@ -24,83 +35,460 @@ void USB_FrameBuffer_Init(void) {
     frame_manager.state = FRAME_STATE_IDLE;
     frame_manager.received_bytes = 0;
     frame_manager.frame_counter = 0;
+    frame_manager.line_data = false;
+    frame_manager.frame_open = false;
 }
 
 
 
 /**
  * Send a request to host for more data
- * Uses USB CDC to send single command byte
+ * Uses the bulk IN endpoint to send single command byte
  */
 void SendCommands(uint8_t cmd) {
-    // Only send if we haven't already requested
-        CDC_Transmit_FS(&cmd, 1);
-    }
+#if USBD_VGA_BULK
+    VGA_Transmit_FS(&cmd, 1);
+#else
+    CDC_Transmit_FS(&cmd, 1);
+#endif
+}
+
+
 
 
 
+/**
+ * Account for bytes already written at the ring's write position
+ * Every line they complete is handed to the scanout.
+ *
+ * @param len: bytes written after fill, within the free space
+ */
+static void RingBuffer_Publish(uint16_t len) {
+	ring_buffer.fill += len;
+	while (ring_buffer.fill >= ITEM_SIZE) {
+		ring_buffer.fill -= ITEM_SIZE;
+		__DMB();
+		ring_buffer.head++;
+	}
+}
 
 
 /**
  * Write data into ring buffer (called when USB receives pixel data)
- * Data should only be requested when enough space is available
+ * Data should only be requested when enough space is available. Bytes fill
+ * the slot at head, a full slot is handed to the scanout by advancing head.
+ * The barrier keeps the slot contents ahead of the head store. Data that
+ * USB already received at the write position (USB_RxBuffer()) is only
+ * published, not copied.
  *
  * @param data: pointer to pixel data
  * @param len: number of bytes to write
+ * @retval bytes taken, less than len when every slot is full
+ */
+uint16_t RingBuffer_Write( uint8_t* data, uint16_t len) {
+	uint16_t head = ring_buffer.head;
+	uint16_t taken = 0;
+
+	if (data == &ring_buffer.data[head % RING_LINES][ring_buffer.fill]) {
+		// USB_RxBuffer() checked the space when the endpoint was armed
+		uint16_t end = (head % RING_LINES) * ITEM_SIZE + ring_buffer.fill + len;
+		if (end > RING_BUFFER_SIZE) {
+			memcpy(ring_buffer.data[0], ring_buffer.spill, end - RING_BUFFER_SIZE);
+		}
+		RingBuffer_Publish(len);
+		frame_manager.received_bytes += len;
+		return len;
+	}
+
+	while (taken < len) {
+		if ((uint16_t) (head - ring_buffer.tail) >= RING_LINES) {
+			ring_buffer.overflows += len - taken; // scanout still owns the slot
+			break;
+		}
+		uint16_t n = ITEM_SIZE - ring_buffer.fill;
+		if (n > len - taken) {
+			n = len - taken;
+		}
+		memcpy(&ring_buffer.data[head % RING_LINES][ring_buffer.fill], &data[taken], n);
+		taken += n;
+		ring_buffer.fill += n;
+		if (ring_buffer.fill == ITEM_SIZE) {
+			ring_buffer.fill = 0;
+			__DMB();
+			ring_buffer.head = ++head;
+		}
+	}
+	frame_manager.received_bytes += taken;
+	return taken;
+}
+
+
+/**
+ * Write FB_FORMAT_STREAM_RLE records
+ * A record is a length byte and that many bytes of one row: coded as in
+ * rle.h below ITEM_SIZE, plain at exactly ITEM_SIZE. Records may be split
+ * across packets; each gets a slot of its own, so the scanout decodes
+ * straight out of the ring. A bad length byte is skipped.
  *
- *
+ * @param data: records
+ * @param len: number of bytes
+ * @retval bytes taken, less than len when every slot is full
  */
-void RingBuffer_Write( uint8_t* data, uint16_t len) {
+uint16_t RingBuffer_WriteRecords(const uint8_t *data, uint16_t len) {
+	uint16_t head = ring_buffer.head;
+	uint16_t taken = 0;
+
+	while (taken < len) {
+		if (ring_buffer.record == 0) {
+			if ((uint16_t) (head - ring_buffer.tail) >= RING_LINES) {
+				ring_buffer.overflows += len - taken;
+				break;
+			}
+			uint8_t n = data[taken++];
+			if (n != 0 && n <= ITEM_SIZE) {
+				ring_buffer.length[head % RING_LINES] = n;
+				ring_buffer.record = n;
+				ring_buffer.fill = 0;
+			}
+			continue;
+		}
+		uint16_t n = ring_buffer.record;
+		if (n > len - taken) {
+			n = len - taken;
+		}
+		memcpy(&ring_buffer.data[head % RING_LINES][ring_buffer.fill], &data[taken], n);
+		taken += n;
+		ring_buffer.fill += n;
+		ring_buffer.record -= n;
+		if (ring_buffer.record == 0) {
+			ring_buffer.fill = 0;
+			__DMB();
+			ring_buffer.head = ++head;
+		}
+	}
+	frame_manager.received_bytes += taken;
+	return taken;
+}
 
-	ring_buffer.available_bytes += len;
-	if (len > RING_BUFFER_SIZE - ring_buffer.write_pos) {
-		uint16_t space_left = RING_BUFFER_SIZE - ring_buffer.write_pos;
-		memcpy(&ring_buffer.data[ring_buffer.write_pos], data, space_left); //copy to end
-	    ring_buffer.write_pos = 0; //wrap around
-	    uint16_t remaining = len - space_left; //remaining after wrap
-	    memcpy(&ring_buffer.data[ring_buffer.write_pos], &data[space_left], remaining);
-		//copy remaining after wrap
-		ring_buffer.write_pos += remaining;
 
+/**
+ * Oldest line of the ring, for the scanout
+ * Applies a pending discard first.
+ *
+ * @retval slot, NULL when no line is ready
+ */
+static const uint8_t* RingBuffer_Front(void) {
+	uint16_t tail = ring_buffer.tail;
+	uint8_t seq = ring_buffer.discard_seq;
+	__DMB();
+
+	if (seq != ring_buffer.discard_ack) {
+		// Lines of a finished frame nobody will show. A later discard may
+		// already be visible here; one that is behind tail is ignored.
+		uint16_t discard = ring_buffer.discard;
+		ring_buffer.discard_ack = seq;
+		__DMB();
+		if ((uint16_t) (discard - tail) <= (uint16_t) (ring_buffer.head - tail)) {
+			tail = discard;
+			ring_buffer.tail = tail;
+		}
 	}
-	else{
-		memcpy(&ring_buffer.data[ring_buffer.write_pos], data, len);
-		ring_buffer.write_pos += len;
-		frame_manager.received_bytes += len;
+	uint16_t head = ring_buffer.head;
+	if (tail == head) {
+		return NULL; // Not enough data
 	}
+	__DMB();
+	return ring_buffer.data[tail % RING_LINES];
+}
+
 
+/**
+ * Hand the slot from RingBuffer_Front() back to USB
+ * Only after the slot was read, so USB cannot refill it underneath.
+ */
+static void RingBuffer_Release(void) {
+	__DMB();
+	ring_buffer.tail++;
+	frame_manager.processed_bytes += ITEM_SIZE;
 }
 
 
 /**
  * Read a complete line from ring buffer
- * Does NOT advance read pointer - call RingBuffer_ConsumeLine() after reading
+ * Leaves output as it is when no line is ready.
  *
  * @param output: buffer to copy line into (must be LINE_WIDTH bytes)
  *
  */
 void RingBuffer_Read(uint8_t *output) {
-	if (ring_buffer.available_bytes < ITEM_SIZE) {
-		return; // Not enough data
+	const uint8_t *slot = RingBuffer_Front();
+	if (slot) {
+		fastCopy160(output, slot);
+		RingBuffer_Release();
 	}
+}
 
-	fastCopy160(output, &ring_buffer.data[ring_buffer.read_pos]);
-	ring_buffer.available_bytes -= ITEM_SIZE;
-	if (ring_buffer.read_pos + ITEM_SIZE >= RING_BUFFER_SIZE) {
-		ring_buffer.read_pos = 0; //wrap around
+
+/**
+ * Decode a FB_FORMAT_STREAM_RLE line from the ring
+ * Decodes in place from the slot, bounded by RLE_MAX_RUNS. Leaves output as
+ * it is when no line is ready.
+ *
+ * @param output: line buffer (ITEM_SIZE bytes)
+ */
+void RingBuffer_ReadRLE(uint8_t *output) {
+	const uint8_t *slot = RingBuffer_Front();
+	if (slot) {
+		uint8_t n = ring_buffer.length[ring_buffer.tail % RING_LINES];
+		if (n == ITEM_SIZE) {
+			fastCopy160(output, slot);
+		} else {
+			RLE_DecodeLine(output, ITEM_SIZE, slot, n);
+		}
+		RingBuffer_Release();
 	}
-	else{
-		ring_buffer.read_pos += ITEM_SIZE;
+}
+
+
+/**
+ * Drop everything buffered, from the USB side
+ * The scanout owns tail, so it is asked to skip ahead on its next read
+ * instead of having its index reset underneath it.
+ */
+void RingBuffer_Discard(void) {
+	ring_buffer.fill = 0;
+	ring_buffer.record = 0;
+	ring_buffer.discard = ring_buffer.head;
+	__DMB();
+	ring_buffer.discard_seq++;
+}
+
+
+/**
+ * Bytes buffered, including a partly written line
+ * Read from the USB side; tail may advance meanwhile, so this errs high.
+ * RING_BUFFER_SIZE minus this is what RingBuffer_Write() will take, also
+ * right after a discard the scanout has not picked up yet.
+ */
+uint16_t RingBuffer_Available(void) {
+	return (uint16_t) (ring_buffer.head - ring_buffer.tail) * ITEM_SIZE + ring_buffer.fill;
+}
+
+
+
+
+/**
+ * Where the next OUT packet should land, for CDC_Receive_FS()
+ * While a stream frame is received this is the ring's write position, so
+ * the packet goes from the USB packet memory straight into its line slot.
+ * A command or other packet that lands there is handled as usual and does
+ * not advance the ring.
+ * The vendor class (usbd_vga.c) does not use it: it arms the endpoint for
+ * its next buffer before the current packet has moved the write position.
+ *
+ * @param fallback: the CDC receive buffer
+ * @retval buffer for USBD_CDC_SetRxBuffer()
+ */
+uint8_t* USB_RxBuffer(uint8_t *fallback) {
+	if (fb_format == FB_FORMAT_STREAM && frame_manager.state == FRAME_STATE_RECEIVING
+			&& !frame_manager.line_data && RING_BUFFER_SIZE - RingBuffer_Available() >= USB_RX_PACKET) {
+		return &ring_buffer.data[ring_buffer.head % RING_LINES][ring_buffer.fill];
 	}
-	frame_manager.processed_bytes += ITEM_SIZE;
+	return fallback;
 }
 
 
+/**
+ * Move the stream write position to a line of the current frame
+ * Lines the host never delivered are handed to the scanout with whatever
+ * their slot held, so a lost packet costs stale pixels in its own line
+ * instead of shifting everything after it.
+ *
+ * @param line: line in the frame
+ * @param column: byte in the line
+ * @retval payload bytes that are already in place, -1 when the line was
+ *         already handed out or the ring has no room to reach it
+ */
+static int16_t RingBuffer_Seek(uint8_t line, uint8_t column) {
+	int16_t ahead = (int16_t) (uint16_t) (frame_manager.frame_base + line - ring_buffer.head);
+
+	if (ahead < 0) {
+		return -1;
+	}
+	for (; ahead > 0; ahead--) {
+		if ((uint16_t) (ring_buffer.head - ring_buffer.tail) >= RING_LINES) {
+			return -1;
+		}
+		ring_buffer.fill = 0;
+		__DMB();
+		ring_buffer.head++;
+	}
+	if (column >= ring_buffer.fill) {
+		ring_buffer.fill = column;
+		return 0;
+	}
+	return ring_buffer.fill - column;
+}
+
+
+/**
+ * Place one CMD_LINE_DATA packet
+ * The header says where the payload goes, so a lost, repeated or split
+ * packet only costs its own bytes and the next one lands right again.
+ * Packets of an older frame id are late repeats and dropped, a newer id
+ * starts the next frame. A payload longer than the rest of its line
+ * continues on the following lines. Resident frames take line packets in
+ * the bitmap formats and FB_FORMAT_TILES only.
+ *
+ * @param buf: CMD_LINE_DATA, frame id, line, column, length, payload
+ * @param len: packet length
+ */
+static void USB_LinePacket(uint8_t *buf, uint32_t len) {
+	uint8_t id = buf[1];
+	uint8_t line = buf[2];
+	uint8_t column = buf[3];
+	uint16_t n = buf[4];
+	int8_t age = (int8_t) (id - frame_manager.frame_id);
+
+	if (len != (uint32_t)(LINE_HEADER + n) || (frame_manager.frame_open && age < 0)) {
+		frame_manager.dropped_packets++;  // cut, merged or stale
+		return;
+	}
+	if (line >= VRES || column >= ITEM_SIZE) {
+		frame_manager.dropped_packets++;  // outside the frame, a seek would reach into the next one
+		return;
+	}
+	if (!frame_manager.frame_open || age > 0) {
+		frame_manager.frame_id = id;
+		if (fb_format == FB_FORMAT_STREAM && frame_manager.frame_open) {
+			RingBuffer_Seek(VRES, 0);     // hand out what the last frame missed, keeps frames VRES lines apart
+		}
+		frame_manager.frame_open = true;
+		frame_manager.frame_base = ring_buffer.head;
+		ring_buffer.fill = 0;
+	}
+	buf += LINE_HEADER;
+
+	if (fb_format == FB_FORMAT_STREAM) {
+		int16_t done = RingBuffer_Seek(line, column);
+		if (done < 0 || done >= n) {
+			frame_manager.dropped_packets++;
+			return;
+		}
+		RingBuffer_Write(&buf[done], n - done);
+	} else if (fb_format == FB_FORMAT_TEXT) {
+		TEXT_Write(buf, n);               // text packets carry their own cell position
+	} else if (fb_format == FB_FORMAT_4BPP || fb_format == FB_FORMAT_2BPP || fb_format == FB_FORMAT_1BPP
+			|| fb_format == FB_FORMAT_FRC || fb_format == FB_FORMAT_TILES) {
+		uint16_t stride = (fb_format == FB_FORMAT_TILES) ? TILEMAP_COLS : FB_RowBytes(fb_format);
+		FB_Write(line * stride + column, buf, n);
+	} else {
+		// No plain rows of VRES lines: RLE index, ring formats, generated rows,
+		// SPI rows or attribute cells would be overwritten at the wrong place
+		frame_manager.dropped_packets++;
+	}
+}
+
+
+/**
+ * Place bytes of the rectangle announced by CMD_RECT
+ * Only the changed area crosses the link, rows of a rectangle need not line
+ * up with packets. Bytes past the rectangle are ignored. A rectangle that
+ * runs out of stage room is dropped as a whole, a half applied one would
+ * tear.
+ *
+ * @param buf: rectangle data, rows of rect_width bytes
+ * @param len: number of bytes
+ */
+static void USB_RectData(uint8_t *buf, uint32_t len) {
+	uint16_t left = frame_manager.rect_size - frame_manager.received_bytes;
+	if (len > left) {
+		len = left;
+	}
+	if (!(frame_manager.rect_flags & RECT_DROPPED)
+			&& !FB_WriteRect(frame_manager.rect_pos, frame_manager.received_bytes, buf, len,
+					frame_manager.rect_width, frame_manager.rect_flags & RECT_AT_VBLANK)) {
+		FB_DiscardStaged();
+		frame_manager.rect_flags |= RECT_DROPPED;
+		frame_manager.dropped_rects++;
+	}
+	frame_manager.received_bytes += len;
+	if (frame_manager.received_bytes >= frame_manager.rect_size) {
+		if (!(frame_manager.rect_flags & RECT_DROPPED)) {
+			FB_CommitStaged();
+		}
+		frame_manager.state = FRAME_STATE_IDLE;
+	}
+}
+
+
+/**
+ * Start a FB_FORMAT_STREAM_LZ stream at the ring's write position
+ * Streams are independent, a frame's offsets never reach into the last one.
+ */
+static void USB_StartLZ(void) {
+	LZ_Reset(&lz, ring_buffer.data[0], RING_BUFFER_SIZE,
+			(ring_buffer.head % RING_LINES) * ITEM_SIZE + ring_buffer.fill);
+}
+
+
+/**
+ * Decode held FB_FORMAT_STREAM_LZ input into the ring
+ * Runs until the input is used up or the ring is full. Whatever is left
+ * waits for the scanout to free lines, see USB_FrameBuffer_Poll().
+ */
+static void USB_DecodeLZ(void) {
+	uint16_t room = RING_BUFFER_SIZE - RingBuffer_Available();
+	uint16_t before = room;
+	uint32_t t0 = DWT->CYCCNT;
+
+	lz.pos = (ring_buffer.head % RING_LINES) * ITEM_SIZE + ring_buffer.fill;
+	uint16_t used = LZ_Decode(&lz, lz_input, lz_left, &room);
+	RingBuffer_Publish(before - room);
+
+	frame_manager.lz_cycles += DWT->CYCCNT - t0;
+	frame_manager.lz_bytes += before - room;
+	frame_manager.received_bytes += before - room;
+	lz_input += used;
+	lz_left -= used;
+}
+
+
+/**
+ * Whether the last packet is still being decoded
+ * CDC_Receive_FS() leaves the endpoint unarmed meanwhile, the vendor class
+ * takes one more packet into its next buffer first. Then the host is held
+ * off by NAKs instead of CMD_REQUEST_DATA round trips.
+ */
+bool USB_RxHeld(void) {
+	return lz_left != 0;
+}
+
+
+/**
+ * Main loop share of the USB side
+ * Continues decoding a held packet as the scanout frees lines and takes the
+ * next packet once it is used up.
+ */
+void USB_FrameBuffer_Poll(void) {
+	if (lz_left == 0) {
+		return;
+	}
+	USB_DecodeLZ();
+	if (lz_left == 0) {
+#if USBD_VGA_BULK
+		VGA_ResumeReceive();
+#else
+		CDC_ResumeReceive();
+#endif
+	}
+}
 
 
 /**
  * Process received USB data
- * Call this from CDC_Receive_FS() callback in usbd_cdc_if.c
+ * Call this from VGA_Receive_FS() in usbd_vga_if.c or CDC_Receive_FS() in
+ * usbd_cdc_if.c, one packet at a time
  *
  * @param buf: received data buffer
  * @param len: number of bytes received
@@ -113,28 +501,141 @@ void USB_ProcessReceivedData(uint8_t *buf, uint32_t len) {
 		if (byte == CMD_DATA_CHUNK) {
 			// Data chunk header - next bytes are pixel data
 			frame_manager.state = FRAME_STATE_RECEIVING;
+			frame_manager.line_data = false;
+			FB_DiscardStaged();               // pieces of an unfinished rectangle
+			if (fb_format == FB_FORMAT_STREAM_LZ) {
+				USB_StartLZ();
+			}
+		} else if (byte == CMD_LINE_DATA) {
+			// Data packets are placed by their header, see USB_LinePacket()
+			frame_manager.state = FRAME_STATE_RECEIVING;
+			frame_manager.line_data = true;
+			frame_manager.frame_open = false;
 		} else if (byte == CMD_FRAME_END) {
 			// Frame complete
 			frame_manager.state = FRAME_STATE_COMPLETE;
 			frame_manager.frame_counter++;
 			frame_manager.processed_bytes = 0;
 			frame_manager.received_bytes = 0;
-			ring_buffer.available_bytes = 0;
-			ring_buffer.write_pos = 0;
-			ring_buffer.read_pos = 0;
-
-
+			frame_manager.column_width = 0;
+			RingBuffer_Discard();
+
+
+		} else if (byte == CMD_FORMAT_STREAM) {
+			FB_SetFormat(FB_FORMAT_STREAM);
+		} else if (byte == CMD_FORMAT_4BPP) {
+			FB_SetFormat(FB_FORMAT_4BPP);
+		} else if (byte == CMD_FORMAT_2BPP) {
+			FB_SetFormat(FB_FORMAT_2BPP);
+		} else if (byte == CMD_FORMAT_1BPP) {
+			FB_SetFormat(FB_FORMAT_1BPP);
+		} else if (byte == CMD_FORMAT_TEXT) {
+			FB_SetFormat(FB_FORMAT_TEXT);
+		} else if (byte == CMD_FORMAT_TILES) {
+			FB_SetFormat(FB_FORMAT_TILES);
+		} else if (byte == CMD_FORMAT_HIRES) {
+			FB_SetFormat(FB_FORMAT_HIRES);
+		} else if (byte == CMD_FORMAT_ATTR) {
+			FB_SetFormat(FB_FORMAT_ATTR);
+		} else if (byte == CMD_ATTRIBUTES) {
+			frame_manager.state = FRAME_STATE_ATTRIBUTES;
+		} else if (byte == CMD_FORMAT_FRC) {
+			FB_SetFormat(FB_FORMAT_FRC);
+		} else if (byte == CMD_FORMAT_RLE) {
+			FB_SetFormat(FB_FORMAT_RLE);
+		} else if (byte == CMD_RECT) {
+			frame_manager.state = FRAME_STATE_RECT;
+			FB_DiscardStaged();               // pieces of an unfinished rectangle
+		} else if (byte == CMD_FORMAT_STREAM_RLE) {
+			FB_SetFormat(FB_FORMAT_STREAM_RLE);
+		} else if (byte == CMD_FORMAT_STREAM_LZ) {
+			FB_SetFormat(FB_FORMAT_STREAM_LZ);
+			USB_StartLZ();
+		} else if (byte == CMD_PALETTE_444) {
+			frame_manager.state = FRAME_STATE_PALETTE_444;
+		} else if (byte == CMD_SPRITES) {
+			frame_manager.state = FRAME_STATE_SPRITES;
+		} else if (byte == CMD_SCROLL) {
+			frame_manager.state = FRAME_STATE_SCROLL;
+		} else if (byte == CMD_SEEK) {
+			frame_manager.state = FRAME_STATE_SEEK;
+		} else if (byte == CMD_PALETTE) {
+			frame_manager.state = FRAME_STATE_PALETTE;
 		}
+	} else if (frame_manager.line_data && frame_manager.state <= FRAME_STATE_COMPLETE) {
+		// Not waiting for a parameter packet: anything but a line packet is
+		// garbage, dropping it keeps the following packets in place
+		if (byte == CMD_LINE_DATA && len > LINE_HEADER) {
+			USB_LinePacket(buf, len);
+		} else {
+			frame_manager.dropped_packets++;
+		}
+	} else if (frame_manager.state == FRAME_STATE_PALETTE) {
+		FB_SetPalette(buf, 0, len);
+		frame_manager.state = FRAME_STATE_IDLE;
+	} else if (frame_manager.state == FRAME_STATE_SPRITES) {
+		TILE_SetSprites(buf, len);
+		frame_manager.state = FRAME_STATE_IDLE;
+	} else if (frame_manager.state == FRAME_STATE_PALETTE_444) {
+		FB_SetPalette444(buf, 0, len / 2);
+		frame_manager.state = FRAME_STATE_IDLE;
+	} else if (frame_manager.state == FRAME_STATE_ATTRIBUTES) {
+		FB_SetAttributes(buf, len);
+		frame_manager.state = FRAME_STATE_IDLE;
+	} else if (frame_manager.state == FRAME_STATE_RECT && len >= RECT_HEADER) {
+		// Rectangle of the resident frame, data follows in this and the next packets
+		uint16_t stride = (fb_format == FB_FORMAT_TILES) ? TILEMAP_COLS : FB_RowBytes(fb_format);
+		frame_manager.rect_pos = buf[1] * stride + buf[0];
+		frame_manager.rect_width = buf[2];
+		frame_manager.rect_size = buf[2] * buf[3];
+		frame_manager.rect_flags = buf[4] & ~RECT_DROPPED;
+		frame_manager.received_bytes = 0;
+		if (buf[0] >= stride) {
+			// Starts past the row end, FB_WriteRect() clips only what runs over it
+			frame_manager.rect_flags |= RECT_DROPPED;
+			frame_manager.dropped_rects++;
+		}
+		frame_manager.state = FRAME_STATE_RECT_DATA;
+		USB_RectData(&buf[RECT_HEADER], len - RECT_HEADER);
+	} else if (frame_manager.state == FRAME_STATE_RECT_DATA) {
+		USB_RectData(buf, len);
+	} else if (frame_manager.state == FRAME_STATE_SCROLL) {
+		FB_SetScroll(buf[0], buf[1]);
+		frame_manager.state = FRAME_STATE_IDLE;
+	} else if (frame_manager.state == FRAME_STATE_SEEK) {
+		// Following data chunks go to this offset, e.g. the row or column a scroll exposed
+		frame_manager.received_bytes = buf[0] | (buf[1] << 8);
+		frame_manager.column_width = (len > 2) ? buf[2] : 0;
+		frame_manager.state = FRAME_STATE_RECEIVING;
 	} else if (frame_manager.state == FRAME_STATE_RECEIVING) {
 		// Pixel data
-		RingBuffer_Write(buf, len);
+		if (fb_format == FB_FORMAT_STREAM) {
+			RingBuffer_Write(buf, len);
+		} else if (fb_format == FB_FORMAT_STREAM_RLE) {
+			RingBuffer_WriteRecords(buf, len);
+		} else if (fb_format == FB_FORMAT_STREAM_LZ) {
+			lz_input = buf;
+			lz_left = len;
+			USB_DecodeLZ();
+		} else if (fb_format == FB_FORMAT_TEXT) {
+			TEXT_Write(buf, len);
+		} else {
+			// Resident frame, placed by offset and kept until overwritten
+			if (frame_manager.column_width) {
+				FB_WriteColumn(frame_manager.received_bytes, buf, len, frame_manager.column_width);
+				frame_manager.received_bytes += (len / frame_manager.column_width) * FB_RowBytes(fb_format);
+			} else {
+				FB_Write(frame_manager.received_bytes, buf, len);
+				frame_manager.received_bytes += len;
+			}
+		}
 
 	}
 }
 
 
 void RequestChunk(){
-	if (ring_buffer.available_bytes <= (160*15)){
+	if (RingBuffer_Available() <= (160*15)){
 		uint8_t cmd = CMD_REQUEST_DATA;
 		SendCommands(cmd);
 	}
@@ -0,0 +1,134 @@
+/*
+ * fb_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host benchmark of the 4bpp, 2bpp and 1bpp LUT expansion in
+ * Core/Src/framebuffer.c, the same source the scanout renders with. Every
+ * row of a random frame goes through FB_ExpandLine() and is checked pixel by
+ * pixel against palette[], once with a full palette load and again after
+ * single entries were changed with FB_SetPaletteEntry() the way the copper
+ * list does. Prints host cycles per line for the LUT kernels and for a
+ * shift-and-mask loop doing the same work, for comparison. On the target the
+ * row cost shows in VGA_GetProfile()->line_max.
+ *
+ * Build from the repository root, the Tools/sim stand-ins replace the HAL:
+ *   gcc -O2 -no-pie -ITools/sim -ICore/Inc -IDrivers/CMSIS/Device/ST/STM32F1xx/Include \
+ *       -IDrivers/CMSIS/Include Tools/fb/fb_bench.c Core/Src/framebuffer.c Core/Src/rle.c -o fb_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>                // before VGA.h, the stand-in HAL defines __I
+#define CYCLES() __rdtsc()            // reference cycles, close to core cycles on current parts
+#else
+#define CYCLES() 0
+#endif
+#include "VGA.h"
+
+#define ROUNDS 2000                   // frames expanded per timing
+
+static const struct {
+    const char *name;
+    FB_Format_t format;
+    uint8_t bits;
+} cases[] = {
+    { "4bpp", FB_FORMAT_4BPP, 4 },
+    { "2bpp", FB_FORMAT_2BPP, 2 },
+    { "1bpp", FB_FORMAT_1BPP, 1 },
+};
+
+static uint8_t line[HRES] __ALIGNED(4);
+
+
+/**
+ * Palette index of pixel x in a packed row, leftmost pixel in the top bits
+ */
+static uint8_t Index(const uint8_t *src, uint16_t x, uint8_t bits) {
+    uint8_t per_byte = 8 / bits;
+    uint8_t shift = 8 - bits * (x % per_byte + 1);
+    return (src[x / per_byte] >> shift) & ((1 << bits) - 1);
+}
+
+
+/**
+ * Shift-and-mask expansion, what the LUTs replace
+ */
+static void ExpandDirect(uint8_t *dst, const uint8_t *src, uint8_t bits) {
+    for (uint16_t x = 0; x < HRES; x++) {
+        dst[x] = palette[Index(src, x, bits)];
+    }
+}
+
+
+/**
+ * Expand every row of vram and compare with palette[]
+ *
+ * @retval number of wrong pixels
+ */
+static uint32_t Check(FB_Format_t format, uint8_t bits) {
+    uint16_t stride = FB_RowBytes(format);
+    uint32_t bad = 0;
+    for (uint16_t row = 0; row < VRES; row++) {
+        const uint8_t *src = vram + row * stride;
+        FB_ExpandLine(line, src, format);
+        for (uint16_t x = 0; x < HRES; x++) {
+            bad += line[x] != palette[Index(src, x, bits)];
+        }
+    }
+    return bad;
+}
+
+
+int main(void) {
+    int failed = 0;
+    volatile uint32_t sink = 0;
+
+    srand(1);
+    printf("%-6s %12s %13s %8s  %s\n", "format", "LUT cyc/ln", "direct cyc/ln", "speedup", "check");
+    for (uint8_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        FB_Format_t format = cases[c].format;
+        uint16_t stride = FB_RowBytes(format);
+
+        uint8_t colors[PALETTE_SIZE];
+        for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+            colors[i] = rand();
+        }
+        FB_Init();                    // clears vram
+        for (uint16_t i = 0; i < VRAM_SIZE; i++) {
+            vram[i] = rand();
+        }
+        FB_SetPalette(colors, 0, PALETTE_SIZE);
+        uint32_t bad = Check(format, cases[c].bits);
+        for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+            FB_SetPaletteEntry((i * 7) % PALETTE_SIZE, rand());
+            bad += Check(format, cases[c].bits);
+        }
+
+        uint64_t c0 = CYCLES();
+        for (uint32_t r = 0; r < ROUNDS; r++) {
+            for (uint16_t row = 0; row < VRES; row++) {
+                FB_ExpandLine(line, vram + row * stride, format);
+                sink += line[row];
+            }
+        }
+        double lut = (CYCLES() - c0) / ((double) ROUNDS * VRES);
+
+        c0 = CYCLES();
+        for (uint32_t r = 0; r < ROUNDS; r++) {
+            for (uint16_t row = 0; row < VRES; row++) {
+                ExpandDirect(line, vram + row * stride, cases[c].bits);
+                sink += line[row];
+            }
+        }
+        double direct = (CYCLES() - c0) / ((double) ROUNDS * VRES);
+
+        failed += bad != 0;
+        printf("%-6s %12.1f %13.1f %7.1fx  %s\n", cases[c].name, lut, direct, lut > 0 ? direct / lut : 0,
+                bad ? "FAIL" : "ok");
+    }
+    return failed != 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * lz_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host benchmark of the frame codec in Core/Src/lz.c, the same source the
+ * firmware decodes with. Frames are encoded one by one like the host sends
+ * them and decoded through a ring-sized circular window that a consumer
+ * drains one line at a time, as the scanout does. Prints the compressed
+ * size, the USB rate 60 frames per second need and the decoder time and
+ * cycles per output byte, and checks every line that comes out. On the
+ * target the same figure is frame_manager.lz_cycles / lz_bytes.
+ *
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc Tools/lz/lz_bench.c Core/Src/lz.c -lm -o lz_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "lz.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()            // reference cycles, close to core cycles on current parts
+#else
+#define CYCLES() 0
+#endif
+
+#define WIDTH 160                     // HRES
+#define HEIGHT 120                    // VRES
+#define FRAME (WIDTH * HEIGHT)
+#define WINDOW (32 * WIDTH)           // RING_BUFFER_SIZE
+#define FRAMES 120
+#define USB_RATE 1000000.0            // bytes/s CDC bulk sustains in practice, 19 packets per ms at best
+
+typedef void (*Pattern_t)(uint8_t *frame, uint32_t n);
+
+static uint8_t RGB332(double r, double g, double b) {
+    return ((uint8_t) (r * 7.99) & 7) | (((uint8_t) (g * 7.99) & 7) << 3) | (((uint8_t) (b * 3.99) & 3) << 6);
+}
+
+// Status panel: static frame, one bar and a counter change
+static void Dashboard(uint8_t *frame, uint32_t n) {
+    memset(frame, 0x00, FRAME);
+    for (uint16_t y = 10; y < 110; y += 20) {
+        memset(&frame[y * WIDTH + 10], 0x1C, 140);
+    }
+    uint16_t bar = 10 + (n * 3) % 140;
+    for (uint16_t y = 40; y < 50; y++) {
+        memset(&frame[y * WIDTH + 10], 0xE0, bar);
+    }
+    for (uint16_t x = 0; x < 24; x++) {
+        frame[100 * WIDTH + 120 + x] = ((n >> (x / 3)) & 1) ? 0xFF : 0x00;
+    }
+}
+
+// Moving shaded shapes over a gradient, game or animation like
+static void Motion(uint8_t *frame, uint32_t n) {
+    for (uint16_t y = 0; y < HEIGHT; y++) {
+        for (uint16_t x = 0; x < WIDTH; x++) {
+            double dx = x - 80 - 50 * sin(n * 0.05), dy = y - 60 - 30 * cos(n * 0.07);
+            uint8_t in = dx * dx + dy * dy < 600;
+            frame[y * WIDTH + x] = in ? RGB332(1, (x & 15) / 16.0, 0.2) : RGB332(0, y / 120.0, x / 160.0);
+        }
+    }
+}
+
+// Camera like: smooth content with sensor noise in the low bits
+static void Video(uint8_t *frame, uint32_t n) {
+    for (uint16_t y = 0; y < HEIGHT; y++) {
+        for (uint16_t x = 0; x < WIDTH; x++) {
+            double v = 0.5 + 0.25 * sin((x + n) * 0.08) * cos(y * 0.06) + (rand() % 100) / 2000.0;
+            frame[y * WIDTH + x] = RGB332(v, v * 0.8, 1 - v);
+        }
+    }
+}
+
+// Incompressible: every match attempt fails
+static void Noise(uint8_t *frame, uint32_t n) {
+    (void) n;
+    for (uint32_t i = 0; i < FRAME; i++) {
+        frame[i] = rand();
+    }
+}
+
+// One color: longest matches, offset 1
+static void Flat(uint8_t *frame, uint32_t n) {
+    memset(frame, n, FRAME);
+}
+
+static const struct {
+    const char *name;
+    Pattern_t pattern;
+} cases[] = {
+    { "flat", Flat },
+    { "dashboard", Dashboard },
+    { "motion", Motion },
+    { "video", Video },
+    { "noise", Noise },
+};
+
+static uint8_t frames[FRAMES][FRAME];
+static uint8_t coded[FRAMES][LZ_BOUND(FRAME)];
+static uint32_t sizes[FRAMES];
+static uint32_t table[LZ_HASH_SIZE];
+static uint8_t window[WINDOW];
+
+
+static double Seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * Decode every frame through the window, draining a line whenever one is
+ * complete; packets are 64 bytes like CDC OUT transfers
+ *
+ * @retval lines that did not match, or -1 when decoding stalled
+ */
+static int32_t Replay(uint8_t check) {
+    LZ_Decoder_t lz;
+    uint32_t written = 0, read = 0;
+    int32_t bad = 0;
+
+    for (uint32_t f = 0; f < FRAMES; f++) {
+        LZ_Reset(&lz, window, WINDOW, written % WINDOW);
+        for (uint32_t at = 0; at < sizes[f];) {
+            uint16_t len = (sizes[f] - at > 64) ? 64 : sizes[f] - at;
+            uint16_t room = WINDOW - (written - read);
+            uint16_t before = room;
+            uint16_t used = LZ_Decode(&lz, &coded[f][at], len, &room);
+            written += before - room;
+            at += used;
+            for (; written - read >= WIDTH; read += WIDTH) {
+                if (check) {
+                    uint32_t line = read / WIDTH;
+                    bad += memcmp(&window[read % WINDOW], &frames[line / HEIGHT][(line % HEIGHT) * WIDTH], WIDTH) != 0;
+                }
+            }
+            if (used == 0 && before == room && len) {
+                return -1;
+            }
+        }
+        if (written != (f + 1) * FRAME) {
+            return -1;
+        }
+    }
+    return bad;
+}
+
+
+int main(void) {
+    int failed = 0;
+
+    printf("%-10s %8s %7s %9s %9s %9s %9s  %s\n", "case", "bytes", "ratio", "KB/s@60", "enc ns/B", "dec ns/B",
+            "dec cyc/B", "check");
+    for (uint8_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        srand(1);
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            cases[c].pattern(frames[f], f);
+        }
+        uint64_t total = 0;
+        double t0 = Seconds();
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            sizes[f] = LZ_Encode(coded[f], frames[f], FRAME, WINDOW, table);
+            total += sizes[f];
+        }
+        double encode = (Seconds() - t0) / ((double) FRAMES * FRAME);
+
+        int32_t bad = Replay(1);
+        uint32_t rounds = 20;
+        t0 = Seconds();
+        uint64_t c0 = CYCLES();
+        for (uint32_t r = 0; r < rounds; r++) {
+            Replay(0);
+        }
+        double cycles = (CYCLES() - c0) / ((double) rounds * FRAMES * FRAME);
+        double decode = (Seconds() - t0) / ((double) rounds * FRAMES * FRAME);
+
+        double per_frame = (double) total / FRAMES;
+        double rate = per_frame * 60 / 1000.0;
+        failed += bad != 0;
+        printf("%-10s %8.0f %6.2fx %9.0f %9.2f %9.2f %9.2f  %s%s\n", cases[c].name, per_frame, FRAME / per_frame,
+                rate, encode * 1e9, decode * 1e9, cycles, bad ? "FAIL" : "ok",
+                rate * 1000.0 > USB_RATE ? ", over USB" : "");
+    }
+    return failed != 0;
+}
@@ -0,0 +1,272 @@
+/*
+ * ring_stress.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Two-thread stress test of the single-producer/single-consumer line ring in
+ * Core/Src/usb_frame_buffer.c, the same source the firmware runs. A producer
+ * thread plays USB: it writes numbered lines in random chunk sizes with
+ * RingBuffer_Write(), or as FB_FORMAT_STREAM_RLE records with
+ * RingBuffer_WriteRecords(), and now and then cuts a frame short, even
+ * mid-line or mid-record, with RingBuffer_Discard(). A consumer thread plays
+ * the scanout with RingBuffer_Read() or RingBuffer_ReadRLE(). Every line
+ * carries its sequence number and a pattern derived from it, and the
+ * consumer checks that:
+ * - no line is torn or mixed with another one
+ * - sequence numbers only go up, by one within a frame
+ * - a jump lands on the first line of a frame
+ * - no line of a frame is read once its discard has returned
+ * - every line of the last frame arrives
+ * The received-in-place path (USB_RxBuffer) is not covered.
+ *
+ * Build from the repository root, the Tools/sim stand-ins replace the HAL:
+ *   gcc -O2 -Wall -no-pie -pthread -ITools/sim -ICore/Inc -IDrivers/CMSIS/Device/ST/STM32F1xx/Include \
+ *       -IDrivers/CMSIS/Include Tools/ring/ring_stress.c Core/Src/usb_frame_buffer.c \
+ *       Core/Src/framebuffer.c Core/Src/textmode.c Core/Src/tilemap.c Core/Src/rle.c Core/Src/lz.c \
+ *       -o ring_stress
+ * Run with ./ring_stress [-n lines] [-s seed], exit code 1 on failure.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include "usb_frame_buffer.h"
+#include "framebuffer.h"
+#include "usbd_cdc_if.h"
+
+#define FRAME_LINES 120               // VRES, lines between discards
+#define CHUNK_MAX WRITE_CHUNK
+#define CUT_CHANCE 8                  // one frame in this many is cut short
+#define NONE 0xFFFFFFFFU              // header of an output line nothing was read into
+
+DWT_Type sim_dwt;
+
+static uint32_t lines = 2000000;      // per mode
+static uint32_t seed = 1;
+static volatile uint32_t last_seq;    // sequence number of the last line written, final once done is set
+static volatile uint8_t done;
+static volatile uint32_t discards;    // RingBuffer_Discard() calls, producer only
+static volatile uint32_t discarded;   // lines below this were discarded, set after RingBuffer_Discard() returns
+
+// Consumer results
+static uint32_t received, skipped, errors;
+
+
+// Stand-ins for what usb_frame_buffer.c reaches outside the ring
+
+uint8_t CDC_Transmit_FS(uint8_t *Buf, uint16_t Len) {
+    (void) Buf;
+    (void) Len;
+    return USBD_OK;
+}
+
+
+void CDC_ResumeReceive(void) {
+}
+
+
+void fastCopy160(uint8_t *dst, const uint8_t *src) {
+    memcpy(dst, src, ITEM_SIZE);
+}
+
+
+/**
+ * Line seq: the number in the first four bytes, then runs and literals that
+ * depend on it, so both plain and coded records get exercised
+ */
+static void MakeLine(uint8_t *line, uint32_t seq) {
+    memcpy(line, &seq, 4);
+    uint16_t x = 4;
+    uint32_t state = seq * 2654435761U;
+    while (x < ITEM_SIZE) {
+        state = state * 1103515245U + 12345U;
+        uint16_t n = 1 + (state >> 16) % 24;
+        if (n > ITEM_SIZE - x) {
+            n = ITEM_SIZE - x;
+        }
+        if (state & 0x80000000U) {
+            memset(&line[x], seq + x, n);
+        } else {
+            for (uint16_t i = 0; i < n; i++) {
+                line[x + i] = (seq >> (i & 3)) + x + i;
+            }
+        }
+        x += n;
+    }
+}
+
+
+static uint32_t Rand(uint32_t *state) {
+    *state = *state * 1103515245U + 12345U;
+    return *state >> 8;
+}
+
+
+/**
+ * Hand bytes to the ring in random chunks, waiting while it is full like a
+ * host pacing itself
+ */
+static void Push(const uint8_t *data, uint16_t len, uint8_t records, uint32_t *state) {
+    while (len) {
+        uint16_t n = 1 + Rand(state) % CHUNK_MAX;
+        if (n > len) {
+            n = len;
+        }
+        uint16_t taken = records ? RingBuffer_WriteRecords(data, n) : RingBuffer_Write((uint8_t*) data, n);
+        data += taken;
+        len -= taken;
+        if (taken < n) {
+            sched_yield();
+        }
+    }
+}
+
+
+static void* Producer(void *arg) {
+    uint8_t records = *(uint8_t*) arg;
+    uint32_t state = seed;
+    uint8_t line[ITEM_SIZE];
+    uint8_t record[1 + RLE_LINE_MAX(ITEM_SIZE)];
+
+    for (uint32_t seq = 0; seq < lines;) {
+        uint32_t frame_end = seq - seq % FRAME_LINES + FRAME_LINES;
+        uint32_t cut = NONE;
+        if (Rand(&state) % CUT_CHANCE == 0 && frame_end < lines) {
+            cut = seq + Rand(&state) % (frame_end - seq);
+        }
+        for (; seq < frame_end && seq < lines; seq++) {
+            MakeLine(line, seq);
+            const uint8_t *data = line;
+            uint16_t len = ITEM_SIZE;
+            if (records) {
+                uint16_t size = RLE_EncodeLine(&record[1], line, ITEM_SIZE);
+                if (size >= ITEM_SIZE) {
+                    size = ITEM_SIZE;
+                    memcpy(&record[1], line, ITEM_SIZE);
+                }
+                record[0] = size;
+                data = record;
+                len = 1 + size;
+            }
+            if (seq == cut) {
+                Push(data, Rand(&state) % len, records, &state);   // part of a line, then the frame ends
+                break;
+            }
+            Push(data, len, records, &state);
+            last_seq = seq;
+        }
+        if (seq < lines) {
+            // End of frame, as at CMD_FRAME_END: lines nobody read yet are dropped
+            RingBuffer_Discard();
+            __DMB();
+            discarded = frame_end;
+            discards++;
+            seq = frame_end;
+        }
+    }
+    __DMB();
+    done = 1;
+    return NULL;
+}
+
+
+static void* Consumer(void *arg) {
+    uint8_t records = *(uint8_t*) arg;
+    uint8_t out[ITEM_SIZE] __ALIGNED(4);
+    uint8_t expect[ITEM_SIZE];
+    uint32_t next = 0;
+    uint32_t state = ~seed;
+
+    for (;;) {
+        uint8_t finished = done;
+        uint32_t limit = discarded;
+        __DMB();
+        uint32_t none = NONE;
+        memcpy(out, &none, 4);
+        if (records) {
+            RingBuffer_ReadRLE(out);
+        } else {
+            RingBuffer_Read(out);
+        }
+        uint32_t seq;
+        memcpy(&seq, out, 4);
+        if (seq == NONE) {
+            if (finished) {
+                break;
+            }
+            if (Rand(&state) % 4 == 0) {
+                sched_yield();
+            }
+            continue;
+        }
+
+        MakeLine(expect, seq);
+        if (memcmp(out, expect, ITEM_SIZE) != 0) {
+            if (errors++ < 8) {
+                printf("FAIL line %u torn\n", seq);
+            }
+        }
+        if (seq != next && (seq < next || seq % FRAME_LINES != 0)) {
+            if (errors++ < 8) {
+                printf("FAIL line %u after %u\n", seq, next - 1);
+            }
+        }
+        if (seq < limit) {
+            if (errors++ < 8) {
+                printf("FAIL line %u read after the discard of lines below %u\n", seq, limit);
+            }
+        }
+        if (seq > next) {
+            skipped += seq - next;
+        }
+        received++;
+        next = seq + 1;
+    }
+    if (next != last_seq + 1) {
+        errors++;
+        printf("FAIL last line read %u, last written %u\n", next - 1, last_seq);
+    }
+    return NULL;
+}
+
+
+static int Run(uint8_t records) {
+    pthread_t producer, consumer;
+    USB_FrameBuffer_Init();
+    received = skipped = errors = 0;
+    discards = 0;
+    discarded = 0;
+    done = 0;
+    last_seq = 0;
+
+    pthread_create(&consumer, NULL, Consumer, &records);
+    pthread_create(&producer, NULL, Producer, &records);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    printf("%-8s %9u lines read, %8u dropped by %6u discards, %10u bytes waited for room  %s\n",
+            records ? "records" : "lines", received, skipped, discards, ring_buffer.overflows,
+            errors ? "FAIL" : "ok");
+    return errors != 0;
+}
+
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n': lines = strtoul(optarg, NULL, 0); break;
+        case 's': seed = strtoul(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "usage: ring_stress [-n lines] [-s seed]\n");
+            return 2;
+        }
+    }
+    int failed = Run(0);
+    failed += Run(1);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * rle_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host benchmark of the line codec in Core/Src/rle.c, the same source the
+ * firmware decodes with. Runs typical and worst case lines through
+ * RLE_EncodeLine() and RLE_DecodeLine(), checks the round trip and prints
+ * coded size, controls and time per line. Hostile input feeds random bytes
+ * to the decoder to show its bound holds for data no encoder produced.
+ *
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc Tools/rle/rle_bench.c Core/Src/rle.c -o rle_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rle.h"
+
+#define WIDTH 160                     // HRES
+#define LINES 4096                    // lines per case, cycled through when timing
+#define ROUNDS 200
+
+typedef void (*Pattern_t)(uint8_t *line, uint32_t y);
+
+static void Flat(uint8_t *line, uint32_t y) {
+    memset(line, y & 0xFF, WIDTH);
+}
+
+// UI: a few filled spans and a short label
+static void Dashboard(uint8_t *line, uint32_t y) {
+    memset(line, 0x00, WIDTH);
+    memset(&line[8], 0x1C, 40 + y % 20);
+    memset(&line[90], 0xE0, 30);
+    for (uint8_t i = 0; i < 12; i++) {
+        line[130 + i] = (y + i) & 1 ? 0xFF : 0x00;
+    }
+}
+
+static void Gradient(uint8_t *line, uint32_t y) {
+    for (uint16_t x = 0; x < WIDTH; x++) {
+        line[x] = x + y;
+    }
+}
+
+static void Noise(uint8_t *line, uint32_t y) {
+    (void) y;
+    for (uint16_t x = 0; x < WIDTH; x++) {
+        line[x] = rand();
+    }
+}
+
+// Repeat runs of exactly RLE_REPEAT_MIN between single pixels: most controls per pixel
+static void ShortRuns(uint8_t *line, uint32_t y) {
+    for (uint16_t x = 0; x < WIDTH; x++) {
+        line[x] = (x % 4 == 3) ? (uint8_t) (x + y) : (uint8_t) (x / 4);
+    }
+}
+
+// Just inside the bound: RLE_MAX_RUNS controls, alternating repeat and literal
+static void AtBound(uint8_t *line, uint32_t y) {
+    uint16_t x = 0;
+    for (uint8_t run = 0; run < RLE_MAX_RUNS / 2; run++) {
+        uint8_t span = WIDTH / (RLE_MAX_RUNS / 2);
+        memset(&line[x], run + y, RLE_REPEAT_MIN);
+        for (uint8_t i = RLE_REPEAT_MIN; i < span; i++) {
+            line[x + i] = (uint8_t) (run * 7 + i);
+        }
+        x += span;
+    }
+}
+
+static const struct {
+    const char *name;
+    Pattern_t pattern;
+} cases[] = {
+    { "flat", Flat },
+    { "dashboard", Dashboard },
+    { "gradient", Gradient },
+    { "noise", Noise },
+    { "short runs", ShortRuns },
+    { "at bound", AtBound },
+};
+
+static uint8_t raw[LINES][WIDTH];
+static uint8_t coded[LINES][RLE_LINE_MAX(WIDTH)];
+static uint16_t sizes[LINES];
+
+
+static double Seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+/**
+ * Controls a coded line uses, as the decoder counts them
+ */
+static uint16_t Runs(const uint8_t *src, uint16_t size) {
+    uint16_t runs = 0;
+    for (uint16_t pos = 0; pos < size; runs++) {
+        pos += (src[pos] < RLE_LITERAL_MAX) ? src[pos] + 2 : 2;
+    }
+    return runs;
+}
+
+
+int main(void) {
+    uint8_t line[WIDTH];
+    int failed = 0;
+    volatile uint32_t sink = 0;
+
+    printf("%-12s %8s %8s %10s %10s  %s\n", "case", "bytes", "runs", "enc ns", "dec ns", "round trip");
+    for (uint8_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        srand(1);
+        uint32_t total = 0;
+        uint16_t runs_max = 0;
+        for (uint32_t y = 0; y < LINES; y++) {
+            cases[c].pattern(raw[y], y);
+        }
+
+        double t0 = Seconds();
+        for (uint32_t round = 0; round < ROUNDS; round++) {
+            for (uint32_t y = 0; y < LINES; y++) {
+                sizes[y] = RLE_EncodeLine(coded[y], raw[y], WIDTH);
+            }
+        }
+        double encode = (Seconds() - t0) / ((double) ROUNDS * LINES);
+
+        t0 = Seconds();
+        for (uint32_t round = 0; round < ROUNDS; round++) {
+            for (uint32_t y = 0; y < LINES; y++) {
+                RLE_DecodeLine(line, WIDTH, coded[y], sizes[y]);
+                sink += line[y % WIDTH];
+            }
+        }
+        double decode = (Seconds() - t0) / ((double) ROUNDS * LINES);
+
+        uint8_t ok = 1;
+        for (uint32_t y = 0; y < LINES; y++) {
+            RLE_DecodeLine(line, WIDTH, coded[y], sizes[y]);
+            ok &= memcmp(line, raw[y], WIDTH) == 0 && sizes[y] <= RLE_LINE_MAX(WIDTH);
+            uint16_t runs = Runs(coded[y], sizes[y]);
+            ok &= runs <= RLE_MAX_RUNS;
+            runs_max = runs > runs_max ? runs : runs_max;
+            total += sizes[y];
+        }
+        failed += !ok;
+        printf("%-12s %8.1f %8u %10.1f %10.1f  %s\n", cases[c].name, (double) total / LINES, runs_max,
+                encode * 1e9, decode * 1e9, ok ? "ok" : "FAIL");
+    }
+
+    // Random bytes as coded data, the decoder must stay within width and size
+    srand(2);
+    uint8_t guard[WIDTH + 16];
+    for (uint32_t y = 0; y < LINES; y++) {
+        for (uint16_t i = 0; i < RLE_LINE_MAX(WIDTH); i++) {
+            coded[y][i] = rand();
+        }
+        memset(guard, 0xA5, sizeof(guard));
+        uint16_t used = RLE_DecodeLine(guard, WIDTH, coded[y], RLE_LINE_MAX(WIDTH));
+        for (uint16_t i = WIDTH; i < sizeof(guard); i++) {
+            failed += guard[i] != 0xA5;
+        }
+        failed += used > RLE_LINE_MAX(WIDTH);
+    }
+    double t0 = Seconds();
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        for (uint32_t y = 0; y < LINES; y++) {
+            RLE_DecodeLine(line, WIDTH, coded[y], RLE_LINE_MAX(WIDTH));
+            sink += line[y % WIDTH];
+        }
+    }
+    double decode = (Seconds() - t0) / ((double) ROUNDS * LINES);
+    printf("%-12s %8s %8u %10s %10.1f  %s\n", "hostile", "-", RLE_MAX_RUNS, "-", decode * 1e9,
+            failed ? "FAIL" : "bounded");
+    return failed != 0;
+}
@@ -0,0 +1,339 @@
+/*
+ * fb_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host checks of the resident frame formats in Core/Src/framebuffer.c,
+ * built against the stand-ins in this directory. Every row is expanded the
+ * way the scanout does it and compared pixel by pixel with a reference
+ * computed straight from vram and palette[]:
+ * - scroll: FB_ExpandRow() for every x offset and a range of y offsets in
+ *   4bpp, 2bpp and 1bpp, against the rotated row
+ * - attributes: FB_FORMAT_ATTR bitmap and cell colors, scrolled, and
+ *   FB_SetAttributes() packets including cells off the grid
+ * - FRC: the RGB444 split of all 4096 colors, both levels on alternating
+ *   pixels, rows and frames, copper palette changes on split entries and
+ *   the plain 4bpp table after an RGB444 load
+ * - rectangles: FB_WriteRect() clipping at the row end, pieces written at
+ *   once queued behind staged ones, a rectangle too large for the stage and
+ *   pieces dropped before their commit
+ *
+ * Build from the repository root and run, exit code 1 on failure:
+ *   gcc -O2 -Wall -no-pie -ITools/sim -ICore/Inc -IDrivers/CMSIS/Device/ST/STM32F1xx/Include \
+ *       -IDrivers/CMSIS/Include Tools/sim/fb_check.c Core/Src/framebuffer.c Core/Src/rle.c -lm -o fb_check
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "VGA.h"
+
+static uint8_t line[HRES] __ALIGNED(4);
+static int failed;
+
+
+/**
+ * Count a failed case, print the first few
+ */
+static void Fail(const char *what, uint16_t row, uint16_t x) {
+    if (failed++ < 8) {
+        printf("FAIL %s, row %u, pixel %u\n", what, row, x);
+    }
+}
+
+
+static void RandomFrame(void) {
+    uint8_t colors[PALETTE_SIZE];
+    for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+        colors[i] = rand();
+    }
+    FB_SetPalette(colors, 0, PALETTE_SIZE);
+    for (uint16_t i = 0; i < VRAM_SIZE; i++) {
+        vram[i] = rand();
+    }
+}
+
+
+/**
+ * Palette index of pixel x in a packed row, leftmost pixel in the top bits
+ */
+static uint8_t Index(const uint8_t *src, uint16_t x, uint8_t bits) {
+    uint8_t per_byte = 8 / bits;
+    uint8_t shift = 8 - bits * (x % per_byte + 1);
+    return (src[x / per_byte] >> shift) & ((1 << bits) - 1);
+}
+
+
+/**
+ * Scroll registers: screen row r shows vram row (r + y) % VRES starting at
+ * byte x, 4bpp x rounded down to even bytes, the skipped bytes at the right
+ */
+static void CheckScroll(void) {
+    static const struct {
+        FB_Format_t format;
+        uint8_t bits;
+    } formats[] = {
+        { FB_FORMAT_4BPP, 4 },
+        { FB_FORMAT_2BPP, 2 },
+        { FB_FORMAT_1BPP, 1 },
+    };
+    for (uint8_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        FB_Format_t format = formats[f].format;
+        uint8_t bits = formats[f].bits;
+        uint16_t len = FB_RowBytes(format);
+        uint8_t per_byte = 8 / bits;
+        RandomFrame();
+        for (uint16_t x = 0; x < len; x++) {
+            for (uint16_t y = 0; y < VRES; y += 7) {
+                FB_SetScroll(x, y);
+                uint16_t start = (format == FB_FORMAT_4BPP) ? x & ~1 : x;
+                for (uint16_t row = 0; row < VRES; row++) {
+                    const uint8_t *src = vram + ((row + y) % VRES) * len;
+                    uint8_t rotated[HRES / 2];
+                    for (uint16_t i = 0; i < len; i++) {
+                        rotated[i] = src[(start + i) % len];
+                    }
+                    FB_ExpandRow(line, row, 0, format);
+                    for (uint16_t p = 0; p < HRES; p++) {
+                        if (line[p] != palette[Index(rotated, p, bits)]) {
+                            Fail("scroll", row, p);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        printf("scroll %ubpp: %u x offsets, %u y offsets, %u pixels per row\n", bits, len,
+                (VRES + 6) / 7, len * per_byte);
+    }
+    FB_SetScroll(0, 0);
+}
+
+
+/**
+ * Attribute mode: a set bit shows the foreground, a clear bit the background
+ * of the 8x8 cell the pixel falls in after scrolling
+ */
+static void CheckAttributes(void) {
+    RandomFrame();
+    uint16_t len = FB_RowBytes(FB_FORMAT_ATTR);
+    for (uint16_t x = 0; x < len; x++) {
+        for (uint16_t y = 0; y < VRES; y += 5) {
+            FB_SetScroll(x, y);
+            for (uint16_t row = 0; row < VRES; row++) {
+                uint16_t src_row = (row + y) % VRES;
+                FB_ExpandRow(line, row, 0, FB_FORMAT_ATTR);
+                for (uint16_t p = 0; p < HRES; p++) {
+                    uint16_t column = (x + p / 8) % len;
+                    uint8_t bit = (vram[src_row * len + column] >> (7 - p % 8)) & 1;
+                    const uint8_t *cell = &vram[ATTR_BASE + ((src_row / ATTR_CELL) * ATTR_COLS + column) * 2];
+                    if (line[p] != (bit ? cell[0] : cell[1])) {
+                        Fail("attributes", row, p);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    FB_SetScroll(0, 0);
+
+    // Packets: column, row, fg, bg; cells off the grid and a cut group are ignored
+    uint8_t before[VRAM_SIZE];
+    memcpy(before, vram, VRAM_SIZE);
+    const uint8_t packet[] = {
+        0, 0, 0x11, 0x22,
+        ATTR_COLS - 1, ATTR_ROWS - 1, 0x33, 0x44,
+        ATTR_COLS, 0, 0x55, 0x66,
+        0, ATTR_ROWS, 0x77, 0x88,
+        1, 1, 0x99,
+    };
+    FB_SetAttributes(packet, sizeof(packet));
+    memcpy(&before[ATTR_BASE], (const uint8_t[]) { 0x11, 0x22 }, 2);
+    memcpy(&before[ATTR_BASE + (ATTR_ROWS * ATTR_COLS - 1) * 2], (const uint8_t[]) { 0x33, 0x44 }, 2);
+    if (memcmp(before, vram, VRAM_SIZE) != 0) {
+        Fail("attribute packet", 0, 0);
+    }
+    printf("attributes: %u x offsets, %u y offsets, packet\n", len, (VRES + 4) / 5);
+}
+
+
+/**
+ * Lower and upper FRC level of a palette entry, read back through the expand
+ */
+static void Levels(uint8_t index, uint8_t *lower, uint8_t *upper) {
+    uint8_t src[2] = { index * 0x11, index * 0x11 };
+    FB_Expand4bppFRC(line, src, 2, 0);
+    *lower = line[0];
+    *upper = line[1];
+}
+
+
+/**
+ * One channel of a split: the levels are one step apart at most and their
+ * mean is the nearest half step to the RGB444 value
+ */
+static int SplitOk(uint8_t lower, uint8_t upper, uint8_t value, uint8_t max) {
+    return upper >= lower && upper - lower <= 1
+            && fabs((lower + upper) / (2.0 * max) - value / 15.0) <= 0.5 / (2 * max) + 1e-9;
+}
+
+
+/**
+ * FRC: RGB444 split, level phases and palette changes
+ */
+static void CheckFRC(void) {
+    uint8_t colors[PALETTE_SIZE * 2];
+    uint32_t split = 0;
+    for (uint16_t base = 0; base < 4096; base += PALETTE_SIZE) {
+        for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+            colors[i * 2] = (base + i) >> 8;
+            colors[i * 2 + 1] = (base + i) & 0xFF;
+        }
+        FB_SetPalette444(colors, 0, PALETTE_SIZE);
+        for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+            uint16_t rgb = base + i;
+            uint8_t lower, upper;
+            Levels(i, &lower, &upper);
+            split += lower != upper;
+            if (!SplitOk(lower & 7, upper & 7, rgb >> 8, 7) || !SplitOk((lower >> 3) & 7, (upper >> 3) & 7, (rgb >> 4) & 15, 7)
+                    || !SplitOk(lower >> 6, upper >> 6, rgb & 15, 3) || palette[i] != lower) {
+                Fail("RGB444 split", rgb, i);
+            }
+        }
+    }
+
+    // Phases: (row + parity) & 1 picks which pixel of a byte shows the upper level
+    for (uint8_t i = 0; i < PALETTE_SIZE * 2; i++) {
+        colors[i] = rand();
+    }
+    FB_SetPalette444(colors, 0, PALETTE_SIZE);
+    uint8_t lower[PALETTE_SIZE], upper[PALETTE_SIZE];
+    for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+        Levels(i, &lower[i], &upper[i]);
+    }
+    for (uint8_t parity = 0; parity < 2; parity++) {
+        fb_frame_parity = parity;
+        for (uint16_t row = 0; row < VRES; row++) {
+            const uint8_t *src = vram + row * (HRES / 2);
+            FB_ExpandRow(line, row, 0, FB_FORMAT_FRC);
+            for (uint16_t p = 0; p < HRES; p++) {
+                uint8_t index = Index(src, p, 4);
+                uint8_t up = ((p + row + parity) & 1) != 0;
+                if (line[p] != (up ? upper[index] : lower[index])) {
+                    Fail("FRC phase", row, p);
+                    break;
+                }
+            }
+        }
+    }
+    fb_frame_parity = 0;
+
+    // Plain 4bpp shows the lower level only
+    for (uint16_t row = 0; row < VRES; row++) {
+        FB_ExpandRow(line, row, 0, FB_FORMAT_4BPP);
+        for (uint16_t p = 0; p < HRES; p++) {
+            if (line[p] != lower[Index(vram + row * (HRES / 2), p, 4)]) {
+                Fail("4bpp after RGB444 load", row, p);
+                break;
+            }
+        }
+    }
+
+    // Copper change: a split entry keeps its upper level, a single-level one changes both
+    for (uint8_t i = 0; i < PALETTE_SIZE; i++) {
+        uint8_t color = rand(), lo, up;
+        FB_SetPaletteEntry(i, color);
+        Levels(i, &lo, &up);
+        if (lo != color || up != (lower[i] != upper[i] ? upper[i] : color)) {
+            Fail("palette entry in FRC", i, 0);
+        }
+    }
+    printf("FRC: 4096 colors, %u split, both phases in 2 frames, palette entries\n", split);
+}
+
+
+/**
+ * Apply everything committed, as the blank lines of one frame would
+ */
+static void Vblank(void) {
+    FB_LatchStaged();
+    FB_ApplyStaged(FB_STAGE_SIZE);
+}
+
+
+/**
+ * Rectangles: expected vram is built by hand, one case at a time
+ */
+static void CheckRect(void) {
+    static uint8_t expected[VRAM_SIZE];
+    uint8_t data[FB_STAGE_SIZE * 2];
+    uint16_t stride = FB_RowBytes(FB_FORMAT_4BPP);
+    FB_SetFormat(FB_FORMAT_4BPP);
+    for (uint16_t i = 0; i < sizeof(data); i++) {
+        data[i] = i * 7 + 1;
+    }
+
+    // 20 wide at x = 70: 10 bytes per row shown, the rest clipped
+    memset(vram, 0, VRAM_SIZE);
+    memcpy(expected, vram, VRAM_SIZE);
+    for (uint8_t row = 0; row < 3; row++) {
+        memcpy(&expected[(5 + row) * stride + 70], &data[row * 20], 10);
+    }
+    if (!FB_WriteRect(5 * stride + 70, 0, data, 60, 20, false) || memcmp(vram, expected, VRAM_SIZE) != 0) {
+        Fail("rectangle clipped at the row end", 5, 70);
+    }
+
+    // Staged, then written at once over it: the newer bytes win
+    FB_WriteRect(10 * stride, 0, data, 40, 40, true);
+    FB_CommitStaged();
+    FB_WriteRect(10 * stride, 0, &data[100], 40, 40, false);
+    FB_CommitStaged();
+    if (memcmp(vram, expected, VRAM_SIZE) != 0) {
+        Fail("rectangle behind a staged one written early", 10, 0);
+    }
+    Vblank();
+    memcpy(&expected[10 * stride], &data[100], 40);
+    if (memcmp(vram, expected, VRAM_SIZE) != 0) {
+        Fail("rectangle behind a staged one overwritten", 10, 0);
+    }
+
+    // Larger than the stage: refused, not written at once
+    if (FB_WriteRect(20 * stride, 0, data, 5 * 60, 60, true) || memcmp(vram, expected, VRAM_SIZE) != 0) {
+        Fail("rectangle larger than the stage", 20, 0);
+    }
+    FB_DiscardStaged();
+    Vblank();
+    if (memcmp(vram, expected, VRAM_SIZE) != 0) {
+        Fail("dropped rectangle partly shown", 20, 0);
+    }
+
+    // Abandoned before its commit, the next one commits alone
+    FB_WriteRect(30 * stride, 0, data, 30, 30, true);
+    FB_DiscardStaged();
+    FB_WriteRect(40 * stride, 0, &data[50], 30, 30, true);
+    FB_CommitStaged();
+    Vblank();
+    memcpy(&expected[40 * stride], &data[50], 30);
+    if (memcmp(vram, expected, VRAM_SIZE) != 0) {
+        Fail("abandoned rectangle committed", 30, 0);
+    }
+    printf("rectangles: clipping, order behind the stage, stage full, abandoned pieces\n");
+}
+
+
+int main(void) {
+    srand(1);
+    FB_Init();
+    CheckScroll();
+    CheckAttributes();
+    CheckFRC();
+    CheckRect();
+    if (failed) {
+        printf("fb_check: %d FAILED\n", failed);
+    } else {
+        printf("fb_check: ok\n");
+    }
+    return failed ? 1 : 0;
+}
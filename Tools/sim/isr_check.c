@@ -0,0 +1,348 @@
+/*
+ * isr_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Register-level checks of the line interrupts. VGA.c is built against the
+ * stand-ins in this directory like for vga_sim, but the handlers are called
+ * directly with the flags set by hand, one interrupt at a time, and the
+ * registers and line buffer halves are checked after each call:
+ * - VGA_Init: circular DMA over both halves, TIM1 burst length, cycle counter
+ * - VGA_HSync_IRQHandler: clears only UIF, counts lines, re-arms DMA at line 0
+ * - VGA_LineDMA_IRQHandler: HT fills half 0, TC half 1, both count an overrun
+ *   and skip a line, CGIF2 clears the flags, the half DMA reads is not written
+ * - VGA_Profile_t: the cycle counter is advanced inside a FB_FORMAT_CALLBACK
+ *   row, which has to show in callback_max and line_max
+ * - staged rectangles: latched at line 0, copied at most FB_STAGE_CHUNK bytes
+ *   per line after vertical sync and complete before the first prepared row,
+ *   a commit during the frame waits for the next one
+ * - VGA_SetDisplayList: refuses bands FB_ExpandLine cannot render, ATTR, FRC
+ *   and RLE outside vram and HIRES, without touching the pending list
+ *
+ * Build from the repository root and run, exit code 1 on failure:
+ *   gcc -O2 -Wall -Wno-pointer-to-int-cast -no-pie -ITools/sim -ICore/Inc -IDrivers/CMSIS/Device/ST/STM32F1xx/Include \
+ *       -IDrivers/CMSIS/Include \
+ *       Tools/sim/isr_check.c Core/Src/VGA.c Core/Src/VGA_SPI.c Core/Src/framebuffer.c \
+ *       Core/Src/textmode.c Core/Src/tilemap.c Core/Src/usb_frame_buffer.c Core/Src/rle.c \
+ *       Core/Src/lz.c -o isr_check
+ * Add -DVGA_PROFILE=0 to check that the profiling compiles out.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "VGA.h"
+#include "usbd_cdc_if.h"
+
+#define CALLBACK_CYCLES 500           // cycle counter advance inside one callback row
+
+// Peripherals seen by the firmware, see stm32f1xx_hal.h
+TIM_TypeDef sim_tim1, sim_tim2, sim_tim3;
+DMA_TypeDef sim_dma1;
+DMA_Channel_TypeDef sim_dma1_channel[8];
+GPIO_TypeDef sim_gpioa, sim_gpiob;
+SPI_TypeDef sim_spi1;
+RCC_TypeDef sim_rcc;
+DWT_Type sim_dwt;
+CoreDebug_Type sim_coredebug;
+
+TIM_HandleTypeDef htim1 = { TIM1 };
+TIM_HandleTypeDef htim2 = { TIM2 };
+TIM_HandleTypeDef htim3 = { TIM3 };
+DMA_HandleTypeDef hdma_tim1_ch1 = { DMA1_Channel2 };
+
+static int failed;
+
+
+static void check(int ok, const char *what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failed++;
+    }
+}
+
+
+// HAL stand-ins, see stm32f1xx_hal.h
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress,
+        uint32_t DataLength) {
+    DMA_Channel_TypeDef *ch = hdma->Instance;
+    ch->CNDTR = DataLength;
+    ch->CPAR = DstAddress;
+    ch->CMAR = SrcAddress;
+    ch->CCR |= DMA_CCR_TCIE | DMA_CCR_HTIE | DMA_CCR_TEIE | DMA_CCR_EN;
+    return HAL_OK;
+}
+
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+    (void) IRQn;
+    (void) PreemptPriority;
+    (void) SubPriority;
+}
+
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    (void) IRQn;
+}
+
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+    (void) IRQn;
+}
+
+
+uint8_t CDC_Transmit_FS(uint8_t *Buf, uint16_t Len) {
+    (void) Buf;
+    (void) Len;
+    return USBD_OK;
+}
+
+
+void CDC_ResumeReceive(void) {
+}
+
+
+/**
+ * Row generator: source row in every byte, so a half shows which row it holds
+ */
+static void RowTag(uint8_t *line, uint16_t row) {
+    memset(line, row + 1, HRES);
+    DWT->CYCCNT += CALLBACK_CYCLES;
+}
+
+
+/**
+ * Expected content of the first byte of a scanline: row + 1 inside the
+ * image, 0 for blanking and the letterbox
+ */
+static uint8_t Expected(uint16_t line) {
+    const VGA_Mode *m = vga_mode;
+    uint16_t top = m->vsync + m->vbporch + (m->vvisible - VRES * m->upscale) / 2;
+    if (line < top || line >= top + VRES * m->upscale) {
+        return 0;
+    }
+    return (line - top) / m->upscale + 1;
+}
+
+
+/**
+ * Both halves are a whole line of Expected(line) plus a black tail
+ */
+static int HalfHolds(uint8_t half, uint16_t line) {
+    const uint8_t *buffer = lineBuffer[half];
+    for (uint16_t i = 0; i < LINE_BYTES; i++) {
+        if (buffer[i] != (i < HRES ? Expected(line) : 0)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/**
+ * One line DMA interrupt with the given flags
+ * The other half is being shifted out and may be copied from, but not written.
+ *
+ * @param flags: DMA_ISR_HTIF2 and/or DMA_ISR_TCIF2
+ * @param untouched: half DMA is reading
+ */
+static void LineIRQ(uint32_t flags, uint8_t untouched) {
+    uint8_t saved[LINE_BYTES];
+    memcpy(saved, lineBuffer[untouched], LINE_BYTES);
+    DMA1->ISR = flags | DMA_ISR_GIF2;
+    DMA1->IFCR = 0;
+    VGA_LineDMA_IRQHandler();
+    check(DMA1->IFCR == DMA_IFCR_CGIF2, "line handler clears channel 2 with CGIF2 only");
+    check(memcmp(saved, lineBuffer[untouched], LINE_BYTES) == 0, "line handler leaves the half DMA is reading");
+}
+
+
+static void HSync(void) {
+    TIM2->SR = TIM_SR_UIF | TIM_SR_CC1IF | TIM_SR_CC2IF;
+    VGA_HSync_IRQHandler();
+    // rc_w0: a 1 leaves a flag alone, so only UIF may be written as 0
+    check(TIM2->SR == ~(uint32_t) TIM_SR_UIF, "HSYNC handler clears UIF and nothing else");
+}
+
+
+/**
+ * Bytes of vram that differ from a copy
+ */
+static uint16_t Changed(const uint8_t *before) {
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < VRAM_SIZE; i++) {
+        n += vram[i] != before[i];
+    }
+    return n;
+}
+
+
+/**
+ * Staged rectangle: RECT_ROWS rows of RECT_WIDTH bytes from the last vram
+ * row on, wrapping to the first, committed before line 0 and once more
+ * right after it
+ */
+#define RECT_WIDTH 60
+#define RECT_ROWS 4
+static void CheckStaged(void) {
+    static uint8_t before[VRAM_SIZE], expected[VRAM_SIZE];
+    const VGA_Mode *m = vga_mode;
+    uint16_t stride = FB_RowBytes(FB_FORMAT_4BPP);
+    uint16_t pos = VRAM_SIZE - stride + 10;                 // last vram row, the next rows wrap to the start
+    uint8_t data[RECT_WIDTH * RECT_ROWS];
+
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        for (uint16_t i = 0; i < sizeof(data); i++) {
+            data[i] = i % 251 + 1 + pass;
+        }
+        memcpy(expected, vram, VRAM_SIZE);
+        for (uint16_t i = 0; i < sizeof(data); i++) {
+            expected[(pos + (i / RECT_WIDTH) * stride + i % RECT_WIDTH) % VRAM_SIZE] = data[i];
+        }
+
+        if (pass == 1) {
+            current_line = m->vwhole - 1;
+            HSync();
+        }
+        FB_SetFormat(FB_FORMAT_4BPP);
+        FB_WriteRect(pos, 0, data, sizeof(data) / 2, RECT_WIDTH, true);
+        FB_WriteRect(pos, sizeof(data) / 2, &data[sizeof(data) / 2], sizeof(data) / 2, RECT_WIDTH, true);
+        FB_SetFormat(FB_FORMAT_CALLBACK);
+        memcpy(before, vram, VRAM_SIZE);
+        FB_CommitStaged();
+        if (pass == 0) {
+            current_line = m->vwhole - 1;
+            HSync();
+            check(Changed(before) == 0, "staged rectangle only latched at line 0");
+        }
+
+        // Rows are prepared LINEBUFFERS lines ahead, the last copy is a line before
+        uint16_t copied = 0;
+        while (current_line + 1 < m->vsync + m->vbporch - LINEBUFFERS) {
+            HSync();
+            uint16_t n = Changed(before);
+            check(n - copied <= FB_STAGE_CHUNK, "at most FB_STAGE_CHUNK staged bytes per line");
+            check(current_line >= m->vsync || n == 0, "nothing staged copied during vertical sync");
+            copied = n;
+        }
+        if (pass == 0) {
+            check(memcmp(vram, expected, VRAM_SIZE) == 0, "staged rectangle complete before the image");
+        } else {
+            // Committed after line 0: shows in the next frame
+            check(copied == 0, "rectangle committed during the frame waits");
+            current_line = m->vwhole - 1;
+            HSync();
+            while (current_line + 1 < m->vsync + m->vbporch - LINEBUFFERS) {
+                HSync();
+            }
+            check(memcmp(vram, expected, VRAM_SIZE) == 0, "late rectangle complete in the next frame");
+        }
+    }
+}
+
+
+static void CheckDisplayList(void) {
+    static const uint8_t other[HRES];
+    VGA_DisplayEntry_t list[2] = {
+        { vram, 0, 0, 8, 0, FB_FORMAT_4BPP },
+        { other, 0, 0, 0, 0, FB_FORMAT_1BPP },
+    };
+
+    check(VGA_SetDisplayList(list, 2) && VGA_DisplayListPending(), "bitmap band outside vram taken");
+    current_line = vga_mode->vwhole - 1;
+    HSync();
+    const FB_Format_t vram_only[] = { FB_FORMAT_ATTR, FB_FORMAT_FRC, FB_FORMAT_RLE };
+    for (uint8_t i = 0; i < sizeof(vram_only) / sizeof(vram_only[0]); i++) {
+        list[0].format = list[1].format = vram_only[i];
+        check(!VGA_SetDisplayList(list, 2) && !VGA_DisplayListPending(), "band outside vram refused");
+        list[1].src = vram;
+        check(VGA_SetDisplayList(list, 2), "band reading vram taken");
+        list[1].src = other;
+        current_line = vga_mode->vwhole - 1;
+        HSync();
+    }
+    list[1].format = FB_FORMAT_HIRES;
+    check(!VGA_SetDisplayList(list, 2), "hires band refused");
+    check(VGA_SetDisplayList(NULL, 0), "no list taken");
+    current_line = vga_mode->vwhole - 1;
+    HSync();
+}
+
+
+int main(void) {
+    VGA_Init();
+    VGA_SetLineCallback(RowTag);
+    FB_SetFormat(FB_FORMAT_CALLBACK);
+    const VGA_Mode *m = vga_mode;
+
+    check(((uintptr_t) lineBuffer[0] & 3) == 0 && ((uintptr_t) lineBuffer[1] & 3) == 0,
+            "both line buffer halves word aligned");
+    check(DMA1_Channel2->CMAR == (uint32_t) (uintptr_t) lineBuffer, "DMA reads lineBuffer");
+    check(DMA1_Channel2->CPAR == (uint32_t) (uintptr_t) &GPIOB->ODR, "DMA writes GPIOB->ODR");
+    check(DMA1_Channel2->CNDTR == LINEBUFFERS * LINE_BYTES, "DMA runs over both halves");
+    check((DMA1_Channel2->CCR & (DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_EN)) == (DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_EN),
+            "DMA half and full transfer interrupts enabled");
+    check(TIM1->RCR == LINE_BYTES - 1 && (TIM1->CR1 & TIM_CR1_OPM), "TIM1 one-pulse burst of LINE_BYTES");
+    check((TIM1->DIER & TIM_DIER_CC1DE) != 0, "TIM1 CC1 requests DMA");
+#if VGA_PROFILE
+    check((CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk),
+            "cycle counter enabled");
+#else
+    check(DWT->CTRL == 0, "cycle counter left alone without VGA_PROFILE");
+#endif
+
+    // Start of frame: line 0 stops and re-arms DMA from the first half
+    current_line = m->vwhole - 1;
+    DMA1_Channel2->CNDTR = 17;
+    HSync();
+    check(current_line == 0, "HSYNC handler wraps at vwhole");
+    check(DMA1_Channel2->CNDTR == LINEBUFFERS * LINE_BYTES && (DMA1_Channel2->CCR & DMA_CCR_EN),
+            "DMA re-armed over both halves at line 0");
+
+    // One frame in order: HT fills half 0, TC half 1, LINEBUFFERS lines ahead
+    uint16_t errors = failed;
+    for (uint16_t line = 0; line + 1 < m->vwhole; line++) {
+        uint8_t half = line & 1;
+        LineIRQ(half ? DMA_ISR_TCIF2 : DMA_ISR_HTIF2, half ^ 1);
+        if (line + LINEBUFFERS < m->vwhole && !HalfHolds(half, line + LINEBUFFERS)) {
+            printf("FAIL half %u after line %u does not hold line %u\n", half, line, line + LINEBUFFERS);
+            failed++;
+        }
+        HSync();
+        check(current_line == line + 1, "HSYNC handler counts lines");
+        if (failed > errors + 4) {
+            break;
+        }
+    }
+
+    // Overrun: both flags set, half 0 is being read again already
+    const VGA_Profile_t *profile = VGA_GetProfile();
+    uint32_t overruns = profile->overruns;
+    current_line = m->vwhole - 1;
+    HSync();
+    uint16_t image_line = m->vsync + m->vbporch + (m->vvisible - VRES * m->upscale) / 2;
+    for (uint16_t line = 0; line + LINEBUFFERS < image_line; line++) {
+        LineIRQ((line & 1) ? DMA_ISR_TCIF2 : DMA_ISR_HTIF2, (line & 1) ^ 1);
+        HSync();
+    }
+    uint16_t next = current_line + LINEBUFFERS;              // line the next HT would fill
+    LineIRQ(DMA_ISR_HTIF2 | DMA_ISR_TCIF2, 0);
+    check(profile->overruns == overruns + 1, "both flags count one overrun");
+    check(HalfHolds(1, next + 1), "overrun skips a line and fills the second half");
+
+    CheckStaged();
+    CheckDisplayList();
+
+    check(profile->budget == (uint32_t) m->hwhole * m->hdiv, "budget is one line of 72MHz cycles");
+#if VGA_PROFILE
+    check(profile->callback_max >= CALLBACK_CYCLES, "callback_max measures the row generator");
+    check(profile->line_max >= profile->callback_max, "line_max includes the row generator");
+#else
+    check(profile->callback_max == 0 && profile->line_max == 0, "no profiling without VGA_PROFILE");
+#endif
+
+    printf("isr_check: %s, line_max %u, callback_max %u, %s\n", m->name, profile->line_max,
+            profile->callback_max, failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
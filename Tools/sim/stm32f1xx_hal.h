@@ -0,0 +1,127 @@
+/*
+ * stm32f1xx_hal.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host stand-in for the HAL, found before the real one through -ITools/sim.
+ * Register layouts and bit names come from the CMSIS device header, the
+ * peripheral instances are plain structs owned by vga_sim.c. Only what the
+ * display sources use is provided.
+ */
+
+#ifndef SIM_STM32F1XX_HAL_H_
+#define SIM_STM32F1XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// core_cm3.h is target only, skip it and provide the few core pieces used
+#define __CORE_CM3_H_GENERIC
+#define __CORE_CM3_H_DEPENDANT
+#define __I volatile const
+#define __O volatile
+#define __IO volatile
+#define __IM volatile const
+#define __OM volatile
+#define __IOM volatile
+#define __ALIGNED(x) __attribute__((aligned(x)))
+
+#include "stm32f103xb.h"
+
+#define __DMB() __sync_synchronize()
+
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+// Peripherals, all pointers fit in 32 bits because the simulator is linked -no-pie
+extern TIM_TypeDef sim_tim1, sim_tim2, sim_tim3;
+extern DMA_TypeDef sim_dma1;
+extern DMA_Channel_TypeDef sim_dma1_channel[8];     // index 1-7
+extern GPIO_TypeDef sim_gpioa, sim_gpiob;
+extern SPI_TypeDef sim_spi1;
+extern RCC_TypeDef sim_rcc;
+extern DWT_Type sim_dwt;
+extern CoreDebug_Type sim_coredebug;
+
+#undef TIM1
+#undef TIM2
+#undef TIM3
+#undef DMA1
+#undef DMA1_Channel1
+#undef DMA1_Channel2
+#undef DMA1_Channel3
+#undef DMA1_Channel4
+#undef DMA1_Channel5
+#undef DMA1_Channel6
+#undef DMA1_Channel7
+#undef GPIOA
+#undef GPIOB
+#undef SPI1
+#undef RCC
+
+#define TIM1 (&sim_tim1)
+#define TIM2 (&sim_tim2)
+#define TIM3 (&sim_tim3)
+#define DMA1 (&sim_dma1)
+#define DMA1_Channel1 (&sim_dma1_channel[1])
+#define DMA1_Channel2 (&sim_dma1_channel[2])
+#define DMA1_Channel3 (&sim_dma1_channel[3])
+#define DMA1_Channel4 (&sim_dma1_channel[4])
+#define DMA1_Channel5 (&sim_dma1_channel[5])
+#define DMA1_Channel6 (&sim_dma1_channel[6])
+#define DMA1_Channel7 (&sim_dma1_channel[7])
+#define GPIOA (&sim_gpioa)
+#define GPIOB (&sim_gpiob)
+#define SPI1 (&sim_spi1)
+#define RCC (&sim_rcc)
+#define DWT (&sim_dwt)
+#define CoreDebug (&sim_coredebug)
+
+// HAL subset
+typedef enum {
+    HAL_OK,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef struct {
+    DMA_Channel_TypeDef *Instance;
+} DMA_HandleTypeDef;
+
+typedef struct {
+    TIM_TypeDef *Instance;
+} TIM_HandleTypeDef;
+
+#define GPIO_PIN_0  ((uint16_t)0x0001)
+#define GPIO_PIN_1  ((uint16_t)0x0002)
+#define GPIO_PIN_2  ((uint16_t)0x0004)
+#define GPIO_PIN_3  ((uint16_t)0x0008)
+#define GPIO_PIN_4  ((uint16_t)0x0010)
+#define GPIO_PIN_5  ((uint16_t)0x0020)
+#define GPIO_PIN_6  ((uint16_t)0x0040)
+#define GPIO_PIN_7  ((uint16_t)0x0080)
+
+#define TIM_DMA_CC1 TIM_DIER_CC1DE
+#define TIM_TS_ITR1 TIM_SMCR_TS_0
+#define TIM_SLAVEMODE_TRIGGER (TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1)
+#define __HAL_TIM_ENABLE_DMA(__HANDLE__, __DMA__) ((__HANDLE__)->Instance->DIER |= (__DMA__))
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress,
+        uint32_t DataLength);
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
+#endif /* SIM_STM32F1XX_HAL_H_ */
@@ -0,0 +1,21 @@
+/*
+ * usbd_cdc_if.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host stand-in for the CDC interface, commands sent to the host are
+ * counted by vga_sim.c.
+ */
+
+#ifndef SIM_USBD_CDC_IF_H_
+#define SIM_USBD_CDC_IF_H_
+
+#include "stm32f1xx_hal.h"       // reached through usbd_conf.h on the target
+
+#define USBD_OK 0
+
+uint8_t CDC_Transmit_FS(uint8_t *Buf, uint16_t Len);
+void CDC_ResumeReceive(void);
+
+#endif /* SIM_USBD_CDC_IF_H_ */
@@ -0,0 +1,17 @@
+/*
+ * usbd_vga_if.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host stand-in for the vendor bulk interface. The simulator delivers
+ * packets the way the CDC path does, see usbd_cdc_if.h here, and
+ * Tools/usb/bulk_sim.c models the class itself.
+ */
+
+#ifndef SIM_USBD_VGA_IF_H_
+#define SIM_USBD_VGA_IF_H_
+
+#define USBD_VGA_BULK 0
+
+#endif /* SIM_USBD_VGA_IF_H_ */
@@ -0,0 +1,847 @@
+/*
+ * vga_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host scanout simulator. The display sources are built unmodified against
+ * the register stand-ins in this directory; the simulator steps TIM2 in 72MHz
+ * ticks, raises the DMA requests TIM1 and TIM2 CH2 would raise and calls the
+ * interrupt handlers the way stm32f1xx_it.c does. Every pixel transfer lands
+ * in GPIOB->ODR (or in the SPI1 shift register for FB_FORMAT_HIRES), which is
+ * sampled into frames and per-line statistics.
+ *
+ * Build from the repository root:
+ *   gcc -O2 -no-pie -ITools/sim -ICore/Inc -IDrivers/CMSIS/Device/ST/STM32F1xx/Include \
+ *       -IDrivers/CMSIS/Include \
+ *       Tools/sim/vga_sim.c Core/Src/VGA.c Core/Src/VGA_SPI.c Core/Src/framebuffer.c \
+ *       Tools/sim/vga_timing.c Core/Src/textmode.c Core/Src/tilemap.c Core/Src/usb_frame_buffer.c \
+ *       Core/Src/rle.c Core/Src/lz.c -lm -o vga_sim
+ *
+ * -no-pie keeps every address below 4GB, the firmware stores pointers in the
+ * 32-bit DMA address registers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "VGA.h"
+#include "usbd_cdc_if.h"
+#include "vga_timing.h"
+
+#define TICK_HZ 72000000U
+#define MAX_LINE_TICKS 4096
+#define MAX_WIDTH 1024
+#define MAX_HEIGHT 1024
+
+// Peripherals seen by the firmware, see stm32f1xx_hal.h
+TIM_TypeDef sim_tim1, sim_tim2, sim_tim3;
+DMA_TypeDef sim_dma1;
+DMA_Channel_TypeDef sim_dma1_channel[8];
+GPIO_TypeDef sim_gpioa, sim_gpiob;
+SPI_TypeDef sim_spi1;
+RCC_TypeDef sim_rcc;
+DWT_Type sim_dwt;
+CoreDebug_Type sim_coredebug;
+
+// Handles defined by main.c on the target
+TIM_HandleTypeDef htim1 = { TIM1 };
+TIM_HandleTypeDef htim2 = { TIM2 };
+TIM_HandleTypeDef htim3 = { TIM3 };
+DMA_HandleTypeDef hdma_tim1_ch1 = { DMA1_Channel2 };
+
+// Interrupts the simulator delivers
+typedef enum {
+    IRQ_HSYNC,                        // TIM2 update
+    IRQ_LINE_DMA,                     // DMA1_Channel2 half/full transfer
+    IRQ_SPI_DMA,                      // DMA1_Channel3 transfer complete
+    IRQ_COUNT
+} SimIrq_t;
+
+typedef struct {
+    uint16_t reload;                  // CNDTR when the channel was enabled
+    uint8_t enabled;
+} SimChannel_t;
+
+// Per-line record, one CSV row with -s
+typedef struct {
+    uint32_t frame;
+    uint16_t line;                    // current_line after the HSYNC handler
+    uint16_t dma;                     // GPIOB transfers
+    uint16_t spi;                     // bytes shifted out on MOSI
+    int32_t first;                    // tick of the first pixel transfer, -1 for none
+    int32_t last;                     // tick of the last pixel transfer
+    uint16_t irqs;                    // line and SPI DMA handlers run
+    uint32_t overruns;                // VGA_Profile_t.overruns added on this line
+    uint16_t lit;                     // non-black dots inside the visible window
+    uint16_t blank_lit;               // non-black ticks in porches and sync
+    uint16_t hsync;                   // ticks HSYNC was active
+    uint8_t vsync;                    // VSYNC active at the start of the line
+} SimLineStats_t;
+
+static uint8_t nvic_enabled[64];
+static uint8_t irq_pending[IRQ_COUNT];
+static uint64_t irq_due[IRQ_COUNT];
+static uint32_t irq_latency = 12;     // Cortex-M3 exception entry
+static SimChannel_t channel[8];
+static uint64_t now;                  // 72MHz ticks since start
+
+static struct {
+    uint8_t running;
+    uint16_t left;                    // requests left in the burst
+    uint64_t next;                    // tick of the next CC1 match
+} tim1;
+
+static struct {
+    uint8_t shift;
+    uint8_t bits;                     // bits left in the shift register
+    uint8_t buffered;                 // DR holds a byte
+    uint8_t mosi;
+    uint64_t next_bit;
+} spi;
+
+// Checksums of the last frame for -c, per demo and mode. A change in the
+// renderers that alters the picture shows here; update the value after
+// checking the new picture with -o.
+static const struct {
+    const char *demo;
+    uint8_t mode;
+    uint32_t checksum;
+} golden[] = {
+    { "text", VGA_MODE_640x480_60, 0xaf38b875 },
+    { "text", VGA_MODE_640x400_70, 0x4e235515 },
+    { "text", VGA_MODE_720x400_70, 0xbc552b37 },
+    { "text", VGA_MODE_800x600_56, 0x836bfcdd },
+    { "tiles", VGA_MODE_640x480_60, 0x3d99f1e5 },
+    { "tiles", VGA_MODE_640x400_70, 0x98307845 },
+    { "tiles", VGA_MODE_720x400_70, 0x34de806b },
+    { "tiles", VGA_MODE_800x600_56, 0xdbf85807 },
+};
+
+static uint32_t cdc_sent[256];        // commands sent to the host
+static uint8_t rx_buffer[USB_RX_PACKET];  // UserRxBufferFS
+static uint32_t rx_in_place;          // packets received straight into the ring
+static uint32_t rx_resumed;           // packets held until the main loop had decoded them
+static SimLineStats_t stats;
+
+
+/**
+ * Latch the reload value when a channel gets enabled
+ * The firmware only writes CNDTR with the channel off, so the value at the
+ * enable edge is what the channel reloads to in circular mode.
+ *
+ * @param n: channel 1-7
+ */
+static void SIM_TrackChannel(uint8_t n) {
+    uint8_t enabled = (sim_dma1_channel[n].CCR & DMA_CCR_EN) != 0;
+    if (enabled && !channel[n].enabled) {
+        channel[n].reload = sim_dma1_channel[n].CNDTR;
+    }
+    channel[n].enabled = enabled;
+}
+
+
+static void SIM_TrackChannels(void) {
+    for (uint8_t n = 1; n < 8; n++) {
+        SIM_TrackChannel(n);
+    }
+}
+
+
+static void SIM_Raise(SimIrq_t irq) {
+    if (!irq_pending[irq]) {
+        irq_pending[irq] = 1;
+        irq_due[irq] = now + irq_latency;
+    }
+}
+
+
+/**
+ * One DMA request on a channel
+ * Moves one item from memory to the peripheral register, counts down, sets
+ * the HT/TC flags and raises the channel interrupt when enabled.
+ *
+ * @param n: channel 1-7
+ * @retval 1 when an item was moved, 0 with the channel off or done
+ */
+static uint8_t SIM_DMARequest(uint8_t n) {
+    DMA_Channel_TypeDef *ch = &sim_dma1_channel[n];
+    SIM_TrackChannel(n);
+    if (!(ch->CCR & DMA_CCR_EN) || ch->CNDTR == 0) {
+        return 0;
+    }
+
+    uint32_t msize = 1U << ((ch->CCR & DMA_CCR_MSIZE) >> DMA_CCR_MSIZE_Pos);
+    uint32_t psize = 1U << ((ch->CCR & DMA_CCR_PSIZE) >> DMA_CCR_PSIZE_Pos);
+    uint32_t index = (ch->CCR & DMA_CCR_MINC) ? channel[n].reload - ch->CNDTR : 0;
+    const uint8_t *src = (const uint8_t *) (uintptr_t) (ch->CMAR + index * msize);
+    uint32_t value = 0;
+    memcpy(&value, src, msize);
+    if (psize == 1) {
+        value = (value & 0xFF) * 0x01010101U;      // APB bridge repeats a byte on every lane
+    } else if (psize == 2) {
+        value = (value & 0xFFFF) * 0x00010001U;
+    }
+    *(volatile uint32_t *) (uintptr_t) ch->CPAR = value;
+
+    uint32_t shift = (n - 1) * 4;
+    uint32_t flags = 0;
+    ch->CNDTR--;
+    if (ch->CNDTR == channel[n].reload / 2) {
+        flags |= DMA_ISR_HTIF1;
+    }
+    if (ch->CNDTR == 0) {
+        flags |= DMA_ISR_TCIF1;
+        if (ch->CCR & DMA_CCR_CIRC) {
+            ch->CNDTR = channel[n].reload;
+        }
+    }
+    if (flags) {
+        DMA1->ISR |= (flags | DMA_ISR_GIF1) << shift;
+        uint32_t enabled = ((flags & DMA_ISR_HTIF1) && (ch->CCR & DMA_CCR_HTIE))
+                || ((flags & DMA_ISR_TCIF1) && (ch->CCR & DMA_CCR_TCIE));
+        if (enabled && n == 2 && nvic_enabled[DMA1_Channel2_IRQn]) {
+            SIM_Raise(IRQ_LINE_DMA);
+        } else if (enabled && n == 3 && nvic_enabled[DMA1_Channel3_IRQn]) {
+            SIM_Raise(IRQ_SPI_DMA);
+        }
+    }
+    return 1;
+}
+
+
+/**
+ * Apply the IFCR write of a handler to DMA1->ISR
+ * CGIFx clears all four flags of its channel.
+ */
+static void SIM_DMAClearFlags(void) {
+    uint32_t clear = DMA1->IFCR;
+    for (uint8_t n = 0; n < 7; n++) {
+        if (clear & (DMA_IFCR_CGIF1 << (n * 4))) {
+            clear |= 0xFU << (n * 4);
+        }
+    }
+    DMA1->ISR &= ~clear;
+    DMA1->IFCR = 0;
+}
+
+
+/**
+ * Run the handlers that are due, in the order they were raised
+ */
+static void SIM_RunInterrupts(void) {
+    for (;;) {
+        int8_t next = -1;
+        for (uint8_t i = 0; i < IRQ_COUNT; i++) {
+            if (irq_pending[i] && irq_due[i] <= now && (next < 0 || irq_due[i] < irq_due[next])) {
+                next = i;
+            }
+        }
+        if (next < 0) {
+            return;
+        }
+        irq_pending[next] = 0;
+        switch (next) {
+        case IRQ_HSYNC:
+            VGA_HSync_IRQHandler();
+            break;
+        case IRQ_LINE_DMA:
+            VGA_LineDMA_IRQHandler();
+            stats.irqs++;
+            break;
+        case IRQ_SPI_DMA:
+            VGA_SPI_IRQHandler();
+            stats.irqs++;
+            break;
+        }
+        SIM_DMAClearFlags();
+        SIM_TrackChannels();
+    }
+}
+
+
+/**
+ * TIM2 CH2 edge at the first visible dot: TRGO and the CC2 DMA request
+ * TRGO clocks TIM3 (one line) and starts the TIM1 burst.
+ */
+static void SIM_Trigger(void) {
+    if (++TIM3->CNT > TIM3->ARR) {
+        TIM3->CNT = 0;
+        HAL_TIM_PeriodElapsedCallback(&htim3);
+    }
+
+    if ((TIM1->SMCR & TIM_SMCR_SMS) == TIM_SLAVEMODE_TRIGGER && !tim1.running) {
+        tim1.running = 1;
+        tim1.left = TIM1->RCR + 1;
+        tim1.next = now + TIM1->CCR1;
+    }
+
+    if (TIM2->DIER & TIM_DIER_CC2DE) {
+        SIM_DMARequest(7);
+        SIM_TrackChannels();
+    }
+}
+
+
+/**
+ * TIM1 CC1 match, one GPIOB byte per period while the burst lasts
+ */
+static void SIM_PixelClock(uint16_t tick) {
+    if (!tim1.running || now != tim1.next) {
+        return;
+    }
+    if ((TIM1->DIER & TIM_DIER_CC1DE) && SIM_DMARequest(2)) {
+        if (stats.first < 0) {
+            stats.first = tick;
+        }
+        stats.last = tick;
+        stats.dma++;
+    }
+    tim1.next += TIM1->ARR + 1;
+    if (--tim1.left == 0) {
+        tim1.running = 0;
+    }
+}
+
+
+/**
+ * SPI1 transmit: TXE pulls the next byte through DMA1_Channel3, bits leave
+ * MSB first every 2 << BR ticks. MOSI keeps the last bit when data runs out.
+ */
+static void SIM_SPIClock(uint16_t tick) {
+    if (!(SPI1->CR1 & SPI_CR1_SPE)) {
+        spi.bits = 0;
+        spi.buffered = 0;
+        spi.mosi = 0;
+        return;
+    }
+    if (!spi.buffered && (SPI1->CR2 & SPI_CR2_TXDMAEN) && SIM_DMARequest(3)) {
+        spi.buffered = 1;
+        if (stats.first < 0) {
+            stats.first = tick;
+        }
+        stats.last = tick;
+    }
+    if (spi.bits == 0 && spi.buffered && now >= spi.next_bit) {
+        spi.shift = (uint8_t) SPI1->DR;
+        spi.bits = 8;
+        spi.buffered = 0;
+        spi.next_bit = now;
+        stats.spi++;
+    }
+    if (spi.bits && now >= spi.next_bit) {
+        spi.mosi = spi.shift >> 7;
+        spi.shift <<= 1;
+        spi.bits--;
+        spi.next_bit += 2U << ((SPI1->CR1 & SPI_CR1_BR) >> SPI_CR1_BR_Pos);
+    }
+}
+
+
+// HAL stand-ins, see stm32f1xx_hal.h
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress,
+        uint32_t DataLength) {
+    DMA_Channel_TypeDef *ch = hdma->Instance;
+    ch->CCR &= ~DMA_CCR_EN;
+    SIM_TrackChannels();
+    ch->CNDTR = DataLength;
+    ch->CPAR = DstAddress;
+    ch->CMAR = SrcAddress;
+    ch->CCR |= DMA_CCR_TCIE | DMA_CCR_HTIE | DMA_CCR_TEIE | DMA_CCR_EN;
+    SIM_TrackChannels();
+    return HAL_OK;
+}
+
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+    (void) IRQn;
+    (void) PreemptPriority;
+    (void) SubPriority;
+}
+
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    nvic_enabled[IRQn] = 1;
+}
+
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+    nvic_enabled[IRQn] = 0;
+}
+
+
+uint8_t CDC_Transmit_FS(uint8_t *Buf, uint16_t Len) {
+    if (Len) {
+        cdc_sent[Buf[0]]++;
+    }
+    return USBD_OK;
+}
+
+
+// The endpoint is armed again, the delivery loop checks USB_RxHeld() itself
+void CDC_ResumeReceive(void) {
+    rx_resumed++;
+}
+
+
+/**
+ * Register state left by MX_DMA_Init, MX_TIM1/2/3_Init and the timer starts
+ * in main(), before VGA_Init() runs
+ */
+static void SIM_InitPeripherals(void) {
+    hdma_tim1_ch1.Instance->CCR = DMA_CCR_PL | DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_CIRC;
+    nvic_enabled[DMA1_Channel2_IRQn] = 1;
+    nvic_enabled[TIM2_IRQn] = 1;
+    nvic_enabled[TIM3_IRQn] = 1;
+
+    TIM1->ARR = 12 - 1;
+    TIM2->PSC = 3 - 1;
+    TIM2->ARR = 800 - 1;
+    TIM2->CCMR1 = TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1;          // PWM1, HSYNC active below CCR1
+    TIM2->CCR1 = 96;
+    TIM2->CCER = TIM_CCER_CC1E | TIM_CCER_CC1P;
+    TIM2->DIER = TIM_DIER_UIE;
+    TIM2->CR1 = TIM_CR1_CEN;
+    TIM3->ARR = 524;
+    TIM3->CCMR1 = TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1;
+    TIM3->CCR1 = 2;
+    TIM3->CCER = TIM_CCER_CC1E | TIM_CCER_CC1P;
+    TIM3->SMCR = TIM_TS_ITR1 | TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1 | TIM_SMCR_SMS_0;
+    TIM3->DIER = TIM_DIER_UIE;
+    TIM3->CR1 = TIM_CR1_CEN;
+}
+
+
+/**
+ * Level of a PWM1 output: active while the counter is below CCR1
+ */
+static uint8_t SIM_SyncActive(const TIM_TypeDef *tim, uint32_t count) {
+    return count < tim->CCR1;
+}
+
+
+/**
+ * Pin level of a PWM1 output, CC1P inverts the active level
+ */
+static uint8_t SIM_SyncPin(const TIM_TypeDef *tim, uint32_t count) {
+    return SIM_SyncActive(tim, count) ^ ((tim->CCER & TIM_CCER_CC1P) != 0);
+}
+
+
+/**
+ * Rows a FB_FORMAT_STREAM_RLE packet starts, continuing where the ring's
+ * record parser stands
+ */
+static uint16_t SIM_RecordsIn(const uint8_t *data, uint16_t len) {
+    uint16_t rows = 0;
+    for (uint16_t pos = ring_buffer.record; pos < len; pos += data[pos] + 1) {
+        rows++;
+    }
+    return rows;
+}
+
+
+static void SIM_Demo(const char *name) {
+    if (strcmp(name, "bars") == 0) {
+        for (uint16_t i = 0; i < VRAM_SIZE; i++) {
+            uint8_t color = (i % (HRES / 2)) * PALETTE_SIZE / (HRES / 2);
+            vram[i] = (color << 4) | color;
+        }
+        FB_SetFormat(FB_FORMAT_4BPP);
+    } else if (strcmp(name, "text") == 0) {
+        TEXT_Clear(TEXT_DEFAULT_ATTR);
+        TEXT_Print(0, 0, 0x1F, " VGA scanout simulator                  ");
+        for (uint8_t row = 2; row < TEXT_ROWS; row++) {
+            TEXT_Print(1, row, (row & 0x0F) ? (row & 0x0F) : 0x07, "The quick brown fox jumps over the dog");
+        }
+        FB_SetFormat(FB_FORMAT_TEXT);
+    } else if (strcmp(name, "white") == 0) {
+        memset(vram, 0xFF, VRAM_SIZE);
+        FB_SetFormat(FB_FORMAT_4BPP);
+    } else if (strcmp(name, "tiles") == 0) {
+        // Framed blue field with a checker diagonal and a brick floor, a ball,
+        // an arrow and a ball cut by the left edge
+        for (uint8_t row = 0; row < TILEMAP_ROWS; row++) {
+            for (uint8_t col = 0; col < TILEMAP_COLS; col++) {
+                uint8_t tile = 1;
+                if (row == 0 || col == 0 || col == TILEMAP_COLS - 1) {
+                    tile = 18;
+                } else if (row >= TILEMAP_ROWS - 2) {
+                    tile = 17;
+                } else if ((row + col) % 6 == 0) {
+                    tile = 16;
+                }
+                tilemap[row * TILEMAP_COLS + col] = tile;
+            }
+        }
+        const uint8_t sprite_packet[] = {
+            0, 40 + TILE_SIZE, 50 + TILE_SIZE, 19,
+            1, 100 + TILE_SIZE, 70 + TILE_SIZE, 20,
+            2, TILE_SIZE - 4, 30 + TILE_SIZE, 19,
+        };
+        TILE_SetSprites(sprite_packet, sizeof(sprite_packet));
+        FB_SetFormat(FB_FORMAT_TILES);
+    } else if (strcmp(name, "hires") == 0) {
+        for (uint16_t i = 0; i < VRAM_SIZE; i++) {
+            uint16_t row = i / SPI_ROW_BYTES;
+            vram[i] = ((row / 8 + i % SPI_ROW_BYTES) & 1) ? 0xFF : 0x81;
+        }
+        FB_SetFormat(FB_FORMAT_HIRES);
+    } else if (strcmp(name, "rle") == 0) {
+        // Each row: a run whose length follows the row, 32 literal gradient pixels, a run to the end
+        uint16_t pos = RLE_INDEX_SIZE;
+        for (uint16_t row = 0; row < VRES; row++) {
+            uint8_t left = 3 + row % 96;
+            vram[row * 2] = pos & 0xFF;
+            vram[row * 2 + 1] = pos >> 8;
+            vram[pos++] = left - RLE_REPEAT_MIN + RLE_LITERAL_MAX;
+            vram[pos++] = 0x07;
+            vram[pos++] = 31;
+            for (uint8_t i = 0; i < 32; i++) {
+                vram[pos++] = (i / 4) << 3 | (row / 15) << 6;
+            }
+            vram[pos++] = 0xFF;                      // repeat 130, cut at HRES
+            vram[pos++] = 0xC0;
+        }
+        FB_SetFormat(FB_FORMAT_RLE);
+    }
+}
+
+
+/**
+ * FNV-1a over a captured frame
+ */
+static uint32_t SIM_Checksum(const uint8_t *image, uint16_t w, uint16_t h) {
+    uint32_t hash = 2166136261U;
+    for (uint32_t i = 0; i < (uint32_t) w * h; i++) {
+        hash = (hash ^ image[i]) * 16777619U;
+    }
+    return hash;
+}
+
+
+/**
+ * Compare the last frame with the golden checksum of its demo and mode
+ *
+ * @retval 1 on a mismatch, 0 when it matches or there is no reference
+ */
+static int SIM_CheckGolden(const char *demo, int mode, uint32_t checksum) {
+    for (uint8_t i = 0; i < sizeof(golden) / sizeof(golden[0]); i++) {
+        if (strcmp(golden[i].demo, demo) == 0 && golden[i].mode == mode) {
+            uint8_t ok = golden[i].checksum == checksum;
+            printf("  %-22s   %08x   %08x  %s\n", "image checksum", checksum, golden[i].checksum, ok ? "ok" : "FAIL");
+            return !ok;
+        }
+    }
+    printf("  %-22s   %08x   no reference\n", "image checksum", checksum);
+    return 0;
+}
+
+
+static void SIM_RGB(uint8_t pixel, uint8_t *rgb) {
+    rgb[0] = (pixel & 0x07) * 255 / 7;
+    rgb[1] = ((pixel >> 3) & 0x07) * 255 / 7;
+    rgb[2] = (pixel >> 6) * 255 / 3;
+}
+
+
+static void SIM_WritePPM(const char *prefix, uint32_t frame, const uint8_t *image, uint16_t w, uint16_t h) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s%04u.ppm", prefix, frame);
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return;
+    }
+    fprintf(f, "P6\n%u %u\n255\n", w, h);
+    for (uint32_t i = 0; i < (uint32_t) w * h; i++) {
+        uint8_t rgb[3];
+        SIM_RGB(image[i], rgb);
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+}
+
+
+/**
+ * Append one frame to a YUV4MPEG2 stream, 4:4:4 BT.601 full range
+ * The header is written with the first frame, frames of another size (a mode
+ * switch) are skipped.
+ */
+static void SIM_WriteY4M(FILE *f, const uint8_t *image, uint16_t w, uint16_t h, uint32_t frame_ticks) {
+    static uint16_t y4m_w, y4m_h;
+    if (!y4m_w) {
+        y4m_w = w;
+        y4m_h = h;
+        fprintf(f, "YUV4MPEG2 W%u H%u F%u:%u Ip A1:1 C444\n", w, h, TICK_HZ, frame_ticks);
+    }
+    if (w != y4m_w || h != y4m_h) {
+        fprintf(stderr, "y4m: skipping %ux%u frame\n", w, h);
+        return;
+    }
+    fputs("FRAME\n", f);
+    for (uint8_t plane = 0; plane < 3; plane++) {
+        for (uint32_t i = 0; i < (uint32_t) w * h; i++) {
+            uint8_t rgb[3];
+            SIM_RGB(image[i], rgb);
+            int32_t v;
+            if (plane == 0)
+                v = (77 * rgb[0] + 150 * rgb[1] + 29 * rgb[2] + 128) >> 8;
+            else if (plane == 1)
+                v = ((-43 * rgb[0] - 85 * rgb[1] + 128 * rgb[2] + 128) >> 8) + 128;
+            else
+                v = ((128 * rgb[0] - 107 * rgb[1] - 21 * rgb[2] + 128) >> 8) + 128;
+            fputc(v < 0 ? 0 : v > 255 ? 255 : v, f);
+        }
+    }
+}
+
+
+/**
+ * Read a packet file: little-endian 16-bit length, then that many bytes
+ */
+static uint8_t* SIM_LoadPackets(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = malloc(*size ? *size : 1);
+    if (fread(data, 1, *size, f) != *size) {
+        perror(path);
+        exit(1);
+    }
+    fclose(f);
+    return data;
+}
+
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: vga_sim [options]\n"
+            "  -m mode     VGA_ModeId, 0-%d (default 0)\n"
+            "  -n frames   complete frames to run (default 2)\n"
+            "  -d demo     bars, white, text, tiles, hires, rle or none (default bars)\n"
+            "  -i file     USB packets (16-bit LE length + data) for USB_ProcessReceivedData\n"
+            "  -r lines    scanlines between packets (default 1)\n"
+            "  -l ticks    interrupt latency in 72MHz ticks (default 12)\n"
+            "  -o prefix   write prefixNNNN.ppm for every frame\n"
+            "  -y file     write all frames to a Y4M stream\n"
+            "  -s file     per-line statistics as CSV\n"
+            "  -v file     HSYNC, VSYNC, pixel bus and current_line as VCD\n"
+            "  -c          check the sync pins against VESA timing, the last frame against\n"
+            "              its golden checksum and the mode table, exit 1 on failure\n",
+            VGA_MODE_COUNT - 1);
+    exit(2);
+}
+
+
+int main(int argc, char **argv) {
+    int mode = 0;
+    uint32_t frames = 2;
+    const char *demo = "bars";
+    const char *packet_path = NULL;
+    uint32_t packet_lines = 1;
+    const char *ppm_prefix = NULL;
+    const char *y4m_path = NULL;
+    const char *stats_path = NULL;
+    const char *vcd_path = NULL;
+    uint8_t check = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:n:d:i:r:l:o:y:s:v:ch")) != -1) {
+        switch (opt) {
+        case 'm': mode = atoi(optarg); break;
+        case 'n': frames = atoi(optarg); break;
+        case 'd': demo = optarg; break;
+        case 'i': packet_path = optarg; break;
+        case 'r': packet_lines = atoi(optarg) ? atoi(optarg) : 1; break;
+        case 'l': irq_latency = atoi(optarg); break;
+        case 'o': ppm_prefix = optarg; break;
+        case 'y': y4m_path = optarg; break;
+        case 's': stats_path = optarg; break;
+        case 'v': vcd_path = optarg; break;
+        case 'c': check = 1; break;
+        default: usage();
+        }
+    }
+    if (mode < 0 || mode >= VGA_MODE_COUNT) {
+        usage();
+    }
+    if (check && frames < 3) {
+        frames = 3;                   // counting starts at the first VSYNC after the first frame start
+    }
+
+    size_t packet_size = 0, packet_pos = 0;
+    uint8_t *packets = packet_path ? SIM_LoadPackets(packet_path, &packet_size) : NULL;
+    FILE *y4m = y4m_path ? fopen(y4m_path, "wb") : NULL;
+    FILE *csv = stats_path ? fopen(stats_path, "w") : NULL;
+    if ((y4m_path && !y4m) || (stats_path && !csv)) {
+        perror("output");
+        return 1;
+    }
+    if (vcd_path) {
+        TIMING_OpenVCD(vcd_path);
+    }
+    if (csv) {
+        fputs("frame,line,dma,spi,first,last,irqs,overruns,lit,blank_lit,hsync,vsync\n", csv);
+    }
+
+    static uint8_t bus[MAX_LINE_TICKS];
+    static uint8_t image[MAX_WIDTH * MAX_HEIGHT];
+    uint16_t width = 0, height = 0;
+    uint32_t frame = 0;
+    uint8_t capturing = 0;
+    uint32_t line_count = 0;
+    uint32_t frame_ticks = 0;
+    uint32_t checksum = 0;
+
+    SIM_InitPeripherals();
+    VGA_Init();
+    VGA_SetMode(mode);
+    SIM_Demo(demo);
+
+    while (frame < frames) {
+        uint32_t hdiv = TIM2->PSC + 1;
+        uint32_t line_ticks = (TIM2->ARR + 1) * hdiv;
+        uint32_t trigger = TIM2->CCR2 * hdiv;
+        uint32_t overruns = VGA_GetProfile()->overruns;
+        if (line_ticks > MAX_LINE_TICKS) {
+            line_ticks = MAX_LINE_TICKS;
+        }
+
+        memset(&stats, 0, sizeof(stats));
+        stats.first = -1;
+        stats.vsync = SIM_SyncActive(TIM3, TIM3->CNT);
+        SIM_Raise(IRQ_HSYNC);
+
+        for (uint32_t tick = 0; tick < line_ticks; tick++, now++) {
+            if (tick == trigger) {
+                SIM_Trigger();
+            }
+            SIM_PixelClock(tick);
+            SIM_SPIClock(tick);
+            SIM_RunInterrupts();
+            bus[tick] = (GPIOB->ODR & 0xFF) | (spi.mosi ? 0xFF : 0x00);
+            if (SIM_SyncActive(TIM2, tick / hdiv)) {
+                stats.hsync++;
+            }
+            if (capturing) {
+                TIMING_Sample(now, SIM_SyncPin(TIM2, tick / hdiv), SIM_SyncPin(TIM3, TIM3->CNT), bus[tick],
+                        current_line);
+            }
+        }
+
+        // Picture of the line, in the window of the mode the line ran in
+        const VGA_Mode *m = vga_mode;
+        uint16_t line = current_line;
+        uint16_t top = m->vsync + m->vbporch;
+        uint32_t vis_start = (m->hsync + m->hbporch) * hdiv;
+        uint32_t vis_ticks = m->hvisible * hdiv;
+        for (uint32_t tick = 0; tick < line_ticks; tick++) {
+            uint8_t visible = line >= top && line < top + m->vvisible
+                    && tick >= vis_start && tick < vis_start + vis_ticks;
+            if (!visible && bus[tick]) {
+                stats.blank_lit++;
+            }
+        }
+
+        if (line == 0) {
+            if (capturing) {
+                if (ppm_prefix) {
+                    SIM_WritePPM(ppm_prefix, frame, image, width, height);
+                }
+                if (y4m) {
+                    SIM_WriteY4M(y4m, image, width, height, frame_ticks);
+                }
+                checksum = SIM_Checksum(image, width, height);
+                frame++;
+            }
+            unsigned w = 0, h = 0;
+            if (sscanf(m->name, "%ux%u", &w, &h) != 2 || w > MAX_WIDTH || m->vvisible > MAX_HEIGHT) {
+                w = m->hvisible > MAX_WIDTH ? MAX_WIDTH : m->hvisible;
+            }
+            width = w;
+            height = m->vvisible;
+            frame_ticks = (uint32_t) m->hwhole * m->hdiv * m->vwhole;
+            memset(image, 0, sizeof(image));
+            if (!capturing) {
+                TIMING_Start(m->name, TICK_HZ);
+            }
+            capturing = 1;
+        }
+        if (capturing && line >= top && line < top + height) {
+            uint8_t *row = image + (uint32_t) (line - top) * width;
+            for (uint16_t x = 0; x < width; x++) {
+                uint8_t pixel = bus[vis_start + ((2 * x + 1) * vis_ticks) / (2 * width)];
+                row[x] = pixel;
+                if (pixel) {
+                    stats.lit++;
+                }
+            }
+        }
+
+        stats.frame = frame;
+        stats.line = line;
+        stats.overruns = VGA_GetProfile()->overruns - overruns;
+        if (csv && capturing) {
+            fprintf(csv, "%u,%u,%u,%u,%d,%d,%u,%u,%u,%u,%u,%u\n", stats.frame, stats.line, stats.dma,
+                    stats.spi, stats.first, stats.last, stats.irqs, stats.overruns, stats.lit,
+                    stats.blank_lit, stats.hsync, stats.vsync);
+        }
+
+        // Main loop share of the line: deliver the next USB packet. Packets up
+        // to the endpoint size land where CDC_Receive_FS armed the endpoint.
+        // Stream data waits while the ring has no room, like a host pacing
+        // itself with CMD_REQUEST_DATA. Coded rows take a slot each, however short.
+        // LZ data is held off by the unarmed endpoint instead.
+        USB_FrameBuffer_Poll();
+        uint16_t len = (packet_pos + 2 <= packet_size) ? packets[packet_pos] | (packets[packet_pos + 1] << 8) : 0;
+        uint8_t room = fb_format != FB_FORMAT_STREAM || RING_BUFFER_SIZE - RingBuffer_Available() >= len;
+        if (fb_format == FB_FORMAT_STREAM_RLE && len > 1 && packet_pos + 2 + len <= packet_size) {
+            room = RING_LINES - (uint16_t) (ring_buffer.head - ring_buffer.tail) - (ring_buffer.record != 0)
+                    >= SIM_RecordsIn(packets + packet_pos + 2, len);
+        }
+        if (packets && ++line_count % packet_lines == 0 && packet_pos + 2 <= packet_size && room && !USB_RxHeld()) {
+            packet_pos += 2;
+            if (packet_pos + len > packet_size) {
+                len = packet_size - packet_pos;
+            }
+            if (len <= USB_RX_PACKET) {
+                uint8_t *rx = USB_RxBuffer(rx_buffer);
+                memcpy(rx, packets + packet_pos, len);
+                rx_in_place += (rx != rx_buffer);
+                USB_ProcessReceivedData(rx, len);
+            } else {
+                USB_ProcessReceivedData(packets + packet_pos, len);
+            }
+            packet_pos += len;
+        }
+    }
+
+    const VGA_Profile_t *profile = VGA_GetProfile();
+    printf("%u frames in %s, %llu ticks\n", frame, vga_mode->name, (unsigned long long) now);
+    printf("overruns %u, frame end %u, data requests %u\n", profile->overruns, cdc_sent[CMD_FRAME_END],
+            cdc_sent[CMD_REQUEST_DATA]);
+    if (packets) {
+        printf("packets: %zu of %zu bytes used, %u received into the ring, %u held for decoding, "
+                "%u bytes dropped on a full ring\n", packet_pos, packet_size, rx_in_place, rx_resumed,
+                ring_buffer.overflows);
+    }
+
+    int failed = check ? TIMING_Report() + SIM_CheckGolden(demo, mode, checksum) + TIMING_CheckModes() : 0;
+    TIMING_Close();
+    if (y4m) {
+        fclose(y4m);
+    }
+    if (csv) {
+        fclose(csv);
+    }
+    free(packets);
+    return failed ? 1 : 0;
+}
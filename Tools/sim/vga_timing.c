@@ -0,0 +1,346 @@
+/*
+ * vga_timing.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#include "vga_timing.h"
+#include "VGA.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define TIMING_TOLERANCE 5.0          // percent line rate deviation; VESA asks for 0.5% pixel clock,
+                                      // which 72MHz cannot divide down to, so this only catches wrong setups
+
+// Reference timings from the VESA DMT / IBM VGA tables, sync first like VGA_Mode
+typedef struct {
+    const char *name;
+    double pclk;                      // MHz
+    uint16_t hvisible, hfporch, hsync, hbporch, hwhole;
+    uint16_t vvisible, vfporch, vsync, vbporch, vwhole;
+    uint8_t hsync_positive, vsync_positive;
+} VesaTiming_t;
+
+static const VesaTiming_t vesa_modes[] = {
+    { "640x480@60", 25.175, 640, 16, 96, 48, 800, 480, 10, 2, 33, 525, 0, 0 },
+    { "640x400@70", 25.175, 640, 16, 96, 48, 800, 400, 12, 2, 35, 449, 0, 1 },
+    { "720x400@70", 28.322, 720, 18, 108, 54, 900, 400, 12, 2, 35, 449, 0, 1 },
+    { "800x600@56", 36.000, 800, 24, 72, 128, 1024, 600, 1, 2, 22, 625, 1, 1 },
+};
+
+static FILE *vcd;
+static uint64_t vcd_origin;
+static int32_t vcd_state[4] = { -1, -1, -1, -1 };
+
+static const VesaTiming_t *ref;
+static uint32_t tick_hz;
+
+// Everything measured from the pins, valid from the first VSYNC start on
+static struct {
+    uint8_t started;
+    uint8_t armed;
+    uint8_t h_active, v_active;
+    uint8_t v_line;                   // VSYNC active at the start of the previous line
+    uint64_t line_start;              // tick of the last HSYNC start
+    uint32_t line;                    // lines since the VSYNC start
+    uint32_t vsync_count;
+    uint64_t period_min, period_max;  // HSYNC start to start, ticks
+    uint64_t width_min, width_max;    // HSYNC pulse, ticks
+    uint32_t vsync_min, vsync_max;    // VSYNC pulse, lines
+    uint32_t vtotal_min, vtotal_max;
+    uint32_t frames;
+    uint64_t vsync_edge;              // ticks from HSYNC start to the VSYNC leading edge
+    uint64_t lit_first, lit_last;     // ticks after HSYNC start
+    uint32_t lit_top, lit_bottom;     // lines after VSYNC start
+    uint8_t lit;
+    uint64_t h_high, h_low, v_high, v_low;
+} m;
+
+
+/**
+ * Start a VCD file, one timestep is 1ps
+ * Signals are the HSYNC and VSYNC pins, the PB0-7 pixel bus (MOSI shows as
+ * 0xFF) and current_line of the firmware.
+ *
+ * @param path: output file
+ */
+void TIMING_OpenVCD(const char *path) {
+    vcd = fopen(path, "w");
+    if (!vcd) {
+        perror(path);
+        return;
+    }
+    fputs("$timescale 1ps $end\n"
+          "$scope module vga $end\n"
+          "$var wire 1 h hsync $end\n"
+          "$var wire 1 v vsync $end\n"
+          "$var wire 8 p pixels $end\n"
+          "$var wire 16 l current_line $end\n"
+          "$upscope $end\n"
+          "$enddefinitions $end\n", vcd);
+}
+
+
+static void TIMING_WriteBits(uint32_t value, uint8_t width, char id) {
+    fputc('b', vcd);
+    for (int8_t bit = width - 1; bit >= 0; bit--) {
+        fputc((value >> bit) & 1 ? '1' : '0', vcd);
+    }
+    fprintf(vcd, " %c\n", id);
+}
+
+
+static void TIMING_WriteVCD(uint64_t tick, uint8_t hsync, uint8_t vsync, uint8_t pixels, uint16_t line) {
+    int32_t state[4] = { hsync, vsync, pixels, line };
+    if (memcmp(state, vcd_state, sizeof(state)) == 0) {
+        return;
+    }
+    if (vcd_state[0] < 0) {
+        vcd_origin = tick;
+    }
+    fprintf(vcd, "#%llu\n", (unsigned long long) ((tick - vcd_origin) * 1000000000000ULL / tick_hz));
+    if (state[0] != vcd_state[0])
+        fprintf(vcd, "%dh\n", hsync);
+    if (state[1] != vcd_state[1])
+        fprintf(vcd, "%dv\n", vsync);
+    if (state[2] != vcd_state[2])
+        TIMING_WriteBits(pixels, 8, 'p');
+    if (state[3] != vcd_state[3])
+        TIMING_WriteBits(line, 16, 'l');
+    memcpy(vcd_state, state, sizeof(state));
+}
+
+
+/**
+ * Begin measuring, counts start with the next VSYNC pulse
+ *
+ * @param mode_name: VGA_Mode name, selects the VESA reference
+ * @param hz: ticks per second of TIMING_Sample()
+ */
+void TIMING_Start(const char *mode_name, uint32_t hz) {
+    memset(&m, 0, sizeof(m));
+    m.period_min = m.width_min = m.lit_first = UINT64_MAX;
+    m.vsync_min = m.vtotal_min = m.lit_top = UINT32_MAX;
+    m.v_line = 1;                     // a pulse already running when sampling starts is not counted
+    tick_hz = hz;
+    ref = NULL;
+    for (uint8_t i = 0; i < sizeof(vesa_modes) / sizeof(vesa_modes[0]); i++) {
+        if (strcmp(vesa_modes[i].name, mode_name) == 0) {
+            ref = &vesa_modes[i];
+        }
+    }
+    m.started = (ref != NULL);
+    if (!ref) {
+        fprintf(stderr, "timing: no VESA reference for %s\n", mode_name);
+    }
+}
+
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/**
+ * Feed the pin levels of one tick
+ *
+ * @param tick: time in ticks of the rate given to TIMING_Start()
+ * @param hsync: HSYNC pin level
+ * @param vsync: VSYNC pin level
+ * @param pixels: PB0-7, 0 is black
+ * @param line: current_line, only used for the VCD
+ */
+void TIMING_Sample(uint64_t tick, uint8_t hsync, uint8_t vsync, uint8_t pixels, uint16_t line) {
+    if (vcd) {
+        TIMING_WriteVCD(tick, hsync, vsync, pixels, line);
+    }
+    if (!m.started) {
+        return;
+    }
+    m.h_high += hsync;
+    m.h_low += !hsync;
+    m.v_high += vsync;
+    m.v_low += !vsync;
+
+    uint8_t h_active = (hsync == ref->hsync_positive);
+    uint8_t v_active = (vsync == ref->vsync_positive);
+
+    if (h_active && !m.h_active) {
+        // Line start. VSYNC is judged at HSYNC starts, like a monitor counts lines
+        if (m.armed && m.line_start) {
+            m.period_min = MIN(m.period_min, tick - m.line_start);
+            m.period_max = MAX(m.period_max, tick - m.line_start);
+        }
+        m.line_start = tick;
+        m.line++;
+        if (v_active && !m.v_line) {
+            if (m.armed) {
+                m.vtotal_min = MIN(m.vtotal_min, m.line);
+                m.vtotal_max = MAX(m.vtotal_max, m.line);
+                m.frames++;
+            }
+            m.armed = 1;
+            m.line = 0;
+            m.vsync_count = 0;
+        }
+        if (v_active) {
+            m.vsync_count++;
+        } else if (m.v_line && m.armed) {
+            m.vsync_min = MIN(m.vsync_min, m.vsync_count);
+            m.vsync_max = MAX(m.vsync_max, m.vsync_count);
+        }
+        m.v_line = v_active;
+    } else if (!h_active && m.h_active && m.armed) {
+        m.width_min = MIN(m.width_min, tick - m.line_start);
+        m.width_max = MAX(m.width_max, tick - m.line_start);
+    }
+    if (v_active && !m.v_active && m.line_start) {
+        m.vsync_edge = tick - m.line_start;
+    }
+    m.h_active = h_active;
+    m.v_active = v_active;
+
+    if (pixels && m.armed) {
+        m.lit = 1;
+        m.lit_first = MIN(m.lit_first, tick - m.line_start);
+        m.lit_last = MAX(m.lit_last, tick - m.line_start);
+        m.lit_top = MIN(m.lit_top, m.line);
+        m.lit_bottom = MAX(m.lit_bottom, m.line);
+    }
+}
+
+
+static int TIMING_Row(const char *what, double measured, double expected, uint8_t ok) {
+    printf("  %-22s %10.3f %10.3f  %s\n", what, measured, expected, ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+
+static int TIMING_Range(const char *what, double first, double last, double start, double end, uint8_t ok) {
+    printf("  %-22s %4.0f..%-5.0f %4.0f..%-5.0f %s\n", what, first, last, start, end, ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+
+/**
+ * Print measured against VESA timing
+ * Horizontal values are in dots of the clock that fits the VESA total into
+ * the measured line, so a stretched line still checks sync and porches.
+ *
+ * @retval number of failed checks, 1 without a complete frame. An all black
+ *         picture counts as failed, it cannot show where the image sits.
+ */
+int TIMING_Report(void) {
+    if (!ref) {
+        return 1;
+    }
+    if (!m.frames || m.period_min == UINT64_MAX || m.vsync_min == UINT32_MAX) {
+        printf("timing: %s, no complete frame measured\n", ref->name);
+        return 1;
+    }
+
+    int failed = 0;
+    double period = (double) m.period_max;
+    double dot = ref->hwhole / period;                         // dots per tick
+    double rate = tick_hz / period / 1000.0;
+    double vesa_rate = ref->pclk * 1000.0 / ref->hwhole;
+    double deviation = (rate / vesa_rate - 1.0) * 100.0;
+    uint8_t h_positive = m.h_high < m.h_low;
+    uint8_t v_positive = m.v_high < m.v_low;
+    double hstart = ref->hsync + ref->hbporch;
+    double vstart = ref->vsync + ref->vbporch;
+
+    printf("timing: %s, %u frames, measured against VESA\n", ref->name, m.frames);
+    printf("  %-22s %10s %10s\n", "", "measured", "VESA");
+    failed += TIMING_Row("line rate kHz", rate, vesa_rate, fabs(deviation) <= TIMING_TOLERANCE);
+    printf("  %-22s %9.2f%%\n", "line rate deviation", deviation);
+    failed += TIMING_Row("line jitter ticks", m.period_max - m.period_min, 0, m.period_max == m.period_min);
+    failed += TIMING_Row("frame rate Hz", tick_hz / (period * m.vtotal_max),
+            ref->pclk * 1e6 / ((double) ref->hwhole * ref->vwhole), fabs(deviation) <= TIMING_TOLERANCE);
+    failed += TIMING_Row("hsync dots", m.width_max * dot, ref->hsync,
+            fabs(m.width_max * dot - ref->hsync) < 1.0 && m.width_max - m.width_min <= 1);
+    failed += TIMING_Row("hsync positive", h_positive, ref->hsync_positive, h_positive == ref->hsync_positive);
+    failed += TIMING_Row("total lines", m.vtotal_max, ref->vwhole,
+            m.vtotal_min == ref->vwhole && m.vtotal_max == ref->vwhole);
+    failed += TIMING_Row("vsync lines", m.vsync_max, ref->vsync,
+            m.vsync_min == ref->vsync && m.vsync_max == ref->vsync);
+    printf("  %-22s %10.0f %10.0f  %s\n", "vsync edge dots", m.vsync_edge * dot, 0.0,
+            "info, VESA starts VSYNC with HSYNC; monitors count it at HSYNC");
+    failed += TIMING_Row("vsync positive", v_positive, ref->vsync_positive, v_positive == ref->vsync_positive);
+
+    if (m.lit) {
+        // Lit area from sync start; must stay inside the visible window (porches black)
+        double first = m.lit_first * dot;
+        double last = (m.lit_last + 1) * dot;
+        failed += TIMING_Range("image dots", first, last, hstart, hstart + ref->hvisible,
+                first > hstart - 1.0 && last < hstart + ref->hvisible + 1.0);
+        failed += TIMING_Range("image lines", m.lit_top, m.lit_bottom + 1, vstart, vstart + ref->vvisible,
+                m.lit_top >= vstart && m.lit_bottom + 1 <= vstart + ref->vvisible);
+    } else {
+        printf("  image                  all black, window not checked  FAIL\n");
+        failed++;
+    }
+    return failed;
+}
+
+
+/**
+ * Check every VGA_Modes entry for consistency
+ * Porches, sync and visible part must add up to the totals, the polarities
+ * must match the VESA reference, the HRES pixel bytes must fit the visible
+ * dots and VRES rows times upscale the visible lines. The TIM1 burst of
+ * LINE_BYTES starts at CCR2 as VGA_ApplyMode() sets it; its black tail may run
+ * into the front porch but has to end before the next HSYNC. The back porch
+ * lines that copy staged rectangles must fit a full stage.
+ *
+ * @retval number of failed checks
+ */
+int TIMING_CheckModes(void) {
+    int failed = 0;
+    for (uint8_t i = 0; i < VGA_MODE_COUNT; i++) {
+        const VGA_Mode *mode = &VGA_Modes[i];
+        const VesaTiming_t *vesa = NULL;
+        for (uint8_t j = 0; j < sizeof(vesa_modes) / sizeof(vesa_modes[0]); j++) {
+            if (strcmp(vesa_modes[j].name, mode->name) == 0) {
+                vesa = &vesa_modes[j];
+            }
+        }
+        uint32_t hdiv = mode->hdiv;
+        int32_t hpixels = ((uint32_t) HRES * mode->dma_div) / hdiv;
+        int32_t start = (mode->hsync + mode->hbporch + (mode->hvisible - hpixels) / 2) * (int32_t) hdiv;
+        int32_t burst_end = start + LINE_BYTES * mode->dma_div;
+
+        printf("mode %u: %s\n", i, mode->name);
+        failed += TIMING_Row("horizontal total", mode->hvisible + mode->hfporch + mode->hsync + mode->hbporch,
+                mode->hwhole, mode->hvisible + mode->hfporch + mode->hsync + mode->hbporch == mode->hwhole);
+        failed += TIMING_Row("vertical total", mode->vvisible + mode->vfporch + mode->vsync + mode->vbporch,
+                mode->vwhole, mode->vvisible + mode->vfporch + mode->vsync + mode->vbporch == mode->vwhole);
+        if (vesa) {
+            failed += TIMING_Row("hsync positive", mode->hsync_positive, vesa->hsync_positive,
+                    mode->hsync_positive == vesa->hsync_positive);
+            failed += TIMING_Row("vsync positive", mode->vsync_positive, vesa->vsync_positive,
+                    mode->vsync_positive == vesa->vsync_positive);
+            failed += TIMING_Row("total lines", mode->vwhole, vesa->vwhole, mode->vwhole == vesa->vwhole);
+        } else {
+            printf("  no VESA reference\n");
+            failed++;
+        }
+        failed += TIMING_Row("pixel ticks", (double) HRES * mode->dma_div, (double) mode->hvisible * hdiv,
+                (uint32_t) HRES * mode->dma_div <= mode->hvisible * hdiv);
+        failed += TIMING_Row("burst end tick", burst_end, (double) mode->hwhole * hdiv,
+                burst_end <= (int32_t) (mode->hwhole * hdiv));
+        failed += TIMING_Row("image lines", (double) VRES * mode->upscale, mode->vvisible,
+                (uint32_t) VRES * mode->upscale <= mode->vvisible);
+        uint32_t stage_bytes = (uint32_t) (mode->vbporch - LINEBUFFERS) * FB_STAGE_CHUNK;
+        failed += TIMING_Row("staged bytes per frame", stage_bytes, FB_STAGE_SIZE, stage_bytes >= FB_STAGE_SIZE);
+    }
+    return failed;
+}
+
+
+void TIMING_Close(void) {
+    if (vcd) {
+        fclose(vcd);
+        vcd = NULL;
+    }
+}
@@ -0,0 +1,25 @@
+/*
+ * vga_timing.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Sync waveform export and VESA check for vga_sim. Works on the pin levels
+ * only (HSYNC, VSYNC, PB0-7/MOSI), so it judges what a monitor would see and
+ * not what the firmware tables say. TIMING_CheckModes() checks the tables
+ * themselves.
+ */
+
+#ifndef SIM_VGA_TIMING_H_
+#define SIM_VGA_TIMING_H_
+
+#include <stdint.h>
+
+void TIMING_OpenVCD(const char *path);
+void TIMING_Start(const char *mode_name, uint32_t tick_hz);
+void TIMING_Sample(uint64_t tick, uint8_t hsync, uint8_t vsync, uint8_t pixels, uint16_t line);
+int TIMING_Report(void);
+int TIMING_CheckModes(void);
+void TIMING_Close(void);
+
+#endif /* SIM_VGA_TIMING_H_ */
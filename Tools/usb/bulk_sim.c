@@ -0,0 +1,359 @@
+/*
+ * bulk_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host model of the vendor bulk class in USB_DEVICE/App/usbd_vga.c against
+ * a mocked PCD. The host sends OUT packets back to back; the endpoint takes
+ * them single or double buffered the way the F1 USB peripheral and the HAL
+ * interrupt handler do, including copying a packet to wherever the transfer
+ * points; the CPU services them in the time the scanline interrupts leave.
+ * Checks that every packet reaches the interface once, in order and intact,
+ * and that no copy lands outside the buffer the class gave the endpoint.
+ * Prints the rate and the NAKed tries, which at full speed cost as much bus
+ * time as a delivered packet.
+ *
+ * -c runs the CDC receive path instead (usbd_cdc_if.c: one buffer, armed
+ * after the packet is processed) for comparison.
+ *
+ * Build from the repository root:
+ *   gcc -O2 -Wall -ITools/usb -IUSB_DEVICE/App -IMiddlewares/ST/STM32_USB_Device_Library/Core/Inc
+ *       Tools/usb/bulk_sim.c USB_DEVICE/App/usbd_vga.c -o bulk_sim
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "usbd_vga.h"
+#include "usbd_ctlreq.h"
+
+#define TICK_NS 100                   // model resolution
+#define BIT_NS 83.333                 // full speed
+#define GAP_NS 1000                   // host controller turnaround between tries
+#define LINE_NS 31778                 // scanline period, 640x480 timing
+#define LIMIT_NS 10000000000ULL       // give up after 10 s of device time
+
+typedef struct {
+    uint32_t seq;
+    uint16_t len;
+} Packet_t;
+
+// OUT endpoint: STAT_RX, the HAL transfer state and the packet memory
+static struct {
+    uint8_t dbl;                      // PCD_DBL_BUF
+    uint8_t valid;                    // STAT_RX VALID, else NAK
+    uint8_t *buff;                    // ep->xfer_buff
+    uint8_t *base;                    // buffer last given by the class
+    uint32_t len;                     // ep->xfer_len
+    uint32_t count;                   // ep->xfer_count
+    Packet_t pma[2];                  // received, CTR_RX pending
+    uint8_t pma_n;
+} ep;
+
+static uint64_t now;                  // ns of device time
+static uint32_t npackets = 20000;
+static uint32_t app_ns = 10000;       // interface time per packet
+static uint32_t isr_ns = 3000;        // PCD handler and packet memory copy
+static uint32_t line_isr_ns = 8000;   // scanline interrupts per line
+static uint32_t slow_every;           // every Nth packet takes ...
+static uint32_t slow_ns;              // ... this much longer, e.g. one that completes a ring line
+static uint32_t hold_every;           // every Nth packet is kept ...
+static uint32_t hold_ns;              // ... for this long
+
+static uint32_t host_sent;            // packets the device ACKed
+static uint64_t host_next;
+static uint64_t host_end;
+static uint8_t host_busy;
+static uint32_t naks;
+static uint64_t nak_ns;
+
+static uint32_t delivered;
+static uint64_t delivered_bytes;
+static uint64_t last_delivery;
+static uint32_t errors;
+static uint32_t strays;
+static uint32_t standbys;
+static uint8_t held;
+static uint64_t hold_until;
+
+static USBD_HandleTypeDef dev;
+static uint8_t cdc_mode;
+static uint8_t cdc_buffer[VGA_DATA_FS_PACKET_SIZE];  // UserRxBufferFS
+
+
+static uint16_t SIM_PacketLen(uint32_t seq) {
+    return (seq % 7 == 3) ? 1 + seq % 50 : VGA_DATA_FS_PACKET_SIZE;  // commands and parameter packets
+}
+
+static uint8_t SIM_PacketByte(uint32_t seq, uint16_t i) {
+    return (uint8_t) (seq * 31 + i * 7 + (seq >> 8));
+}
+
+// One OUT transaction: token, data and handshake, with some bit stuffing
+static uint64_t SIM_WireTime(uint16_t len) {
+    return (uint64_t) ((35 + 8 + (35 + len * 8) * 1.05 + 8 + 19 + 8) * BIT_NS);
+}
+
+
+static void SIM_BusTick(void) {
+    if (!host_busy && host_sent < npackets && now >= host_next) {
+        host_busy = 1;
+        host_end = now + SIM_WireTime(SIM_PacketLen(host_sent));
+    }
+    if (host_busy && now >= host_end) {
+        uint16_t len = SIM_PacketLen(host_sent);
+        uint8_t room = ep.dbl ? ep.pma_n < 2 : ep.pma_n == 0;
+
+        host_busy = 0;
+        host_next = now + GAP_NS;
+        if (ep.valid && room) {
+            ep.pma[ep.pma_n].seq = host_sent++;
+            ep.pma[ep.pma_n].len = len;
+            ep.pma_n++;
+            if (!ep.dbl) {
+                ep.valid = 0;         // single buffered: hardware NAKs until re-armed
+            }
+        } else {
+            naks++;
+            nak_ns += SIM_WireTime(len);
+        }
+    }
+}
+
+static void SIM_Advance(void) {
+    now += TICK_NS;
+    SIM_BusTick();
+}
+
+static uint8_t SIM_InScanout(void) {
+    return (now % LINE_NS) < line_isr_ns;
+}
+
+// CPU time at USB priority, the scanline interrupts preempt it
+static void SIM_Work(uint32_t ns) {
+    while (ns) {
+        SIM_Advance();
+        if (!SIM_InScanout()) {
+            ns = (ns > TICK_NS) ? ns - TICK_NS : 0;
+        }
+    }
+}
+
+
+// Mocked PCD ---------------------------------------------------------------
+
+USBD_StatusTypeDef USBD_LL_OpenEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t ep_type, uint16_t ep_mps) {
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_CloseEP(USBD_HandleTypeDef *pdev, uint8_t ep_addr) {
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_Transmit(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint16_t size) {
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_PrepareReceive(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint16_t size) {
+    ep.buff = ep.base = pbuf;
+    ep.len = size;
+    ep.count = 0;
+    ep.valid = 1;
+    return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_PrepareStandby(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint16_t size) {
+    ep.valid = 0;
+    ep.buff = ep.base = pbuf;
+    ep.len = size;
+    ep.count = 0;
+    standbys++;
+    return USBD_OK;
+}
+
+uint32_t USBD_LL_GetRxDataSize(USBD_HandleTypeDef *pdev, uint8_t ep_addr) {
+    return ep.count;
+}
+
+USBD_StatusTypeDef USBD_CtlSendData(USBD_HandleTypeDef *pdev, uint8_t *pbuf, uint16_t len) {
+    return USBD_OK;
+}
+
+void USBD_CtlError(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req) {
+}
+
+
+// Interface -----------------------------------------------------------------
+
+static int8_t SIM_Init(void) {
+    return USBD_OK;
+}
+
+static int8_t SIM_Receive(uint8_t *buf, uint32_t len) {
+    uint32_t seq = delivered++;
+
+    SIM_Work(app_ns);
+    if (slow_every && seq % slow_every == slow_every - 1) {
+        SIM_Work(slow_ns);
+    }
+    if (len != SIM_PacketLen(seq)) {
+        errors++;
+    } else {
+        for (uint16_t i = 0; i < len; i++) {
+            if (buf[i] != SIM_PacketByte(seq, i)) {
+                errors++;
+                break;
+            }
+        }
+    }
+    delivered_bytes += len;
+    last_delivery = now;
+
+    if (hold_every && seq % hold_every == hold_every - 1) {
+        held = 1;                     // like an LZ packet waiting for ring room
+        hold_until = now + hold_ns;
+        return USBD_BUSY;
+    }
+    return USBD_OK;
+}
+
+static USBD_VGA_ItfTypeDef SIM_fops = {
+    SIM_Init,
+    SIM_Init,
+    SIM_Receive
+};
+
+
+// CDC_Receive_FS(): process, then arm unless held
+static void SIM_CdcDataOut(void) {
+    if (SIM_Receive(cdc_buffer, ep.count) == USBD_OK) {
+        USBD_LL_PrepareReceive(&dev, VGA_OUT_EP, cdc_buffer, VGA_DATA_FS_PACKET_SIZE);
+    }
+}
+
+
+// PCD_EP_ISR_Handler() for the OUT endpoint, one CTR_RX
+static void SIM_PcdInterrupt(void) {
+    Packet_t p = ep.pma[0];
+
+    SIM_Work(isr_ns);
+    ep.pma[0] = ep.pma[1];
+    ep.pma_n--;
+
+    if (ep.dbl) {
+        // HAL_PCD_EP_DB_Receive(): NAK once the transfer length is used up
+        ep.len = (ep.len >= p.len) ? ep.len - p.len : 0;
+        if (ep.len == 0) {
+            ep.valid = 0;
+        }
+    } else {
+        ep.len = 0;
+    }
+    if (ep.buff < ep.base || ep.buff + p.len > ep.base + VGA_DATA_FS_PACKET_SIZE) {
+        strays++;                     // would overwrite whatever follows on the target
+    } else {
+        for (uint16_t i = 0; i < p.len; i++) {
+            ep.buff[i] = SIM_PacketByte(p.seq, i);
+        }
+    }
+    ep.count += p.len;
+    ep.buff += p.len;
+
+    if (ep.len == 0 || p.len < VGA_DATA_FS_PACKET_SIZE) {
+        if (cdc_mode) {
+            SIM_CdcDataOut();
+        } else {
+            USBD_VGA.DataOut(&dev, VGA_OUT_EP);
+        }
+    } else {
+        ep.valid = 1;                 // multi packet transfer continues
+    }
+}
+
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: bulk_sim [options]\n"
+            "  -n packets  OUT packets to send (default 20000)\n"
+            "  -a us       interface time per packet (default 10)\n"
+            "  -i us       scanline interrupt time per %.2f us line (default 8)\n"
+            "  -b n:us     every nth packet takes us longer\n"
+            "  -l n:us     keep every nth packet for us, like LZ waiting for ring room\n"
+            "  -s          single buffered OUT endpoint\n"
+            "  -c          CDC receive path, single buffered\n",
+            LINE_NS / 1000.0);
+    exit(2);
+}
+
+
+int main(int argc, char **argv) {
+    uint8_t single = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:a:i:b:l:sch")) != -1) {
+        switch (opt) {
+        case 'n': npackets = atoi(optarg); break;
+        case 'a': app_ns = atof(optarg) * 1000; break;
+        case 'i': line_isr_ns = atof(optarg) * 1000; break;
+        case 'b':
+            if (sscanf(optarg, "%u:%u", &slow_every, &slow_ns) != 2) {
+                usage();
+            }
+            slow_ns *= 1000;
+            break;
+        case 'l':
+            if (sscanf(optarg, "%u:%u", &hold_every, &hold_ns) != 2) {
+                usage();
+            }
+            hold_ns *= 1000;
+            break;
+        case 's': single = 1; break;
+        case 'c': cdc_mode = 1; single = 1; break;
+        default: usage();
+        }
+    }
+    if (line_isr_ns >= LINE_NS) {
+        usage();
+    }
+
+    ep.dbl = !single;
+    dev.dev_speed = USBD_SPEED_FULL;
+    dev.dev_state = USBD_STATE_CONFIGURED;
+    if (cdc_mode) {
+        USBD_LL_PrepareReceive(&dev, VGA_OUT_EP, cdc_buffer, VGA_DATA_FS_PACKET_SIZE);
+    } else {
+        USBD_VGA_RegisterInterface(&dev, &SIM_fops);
+        USBD_VGA.Init(&dev, 0);
+    }
+
+    while (delivered < npackets && now < LIMIT_NS) {
+        if (ep.pma_n && !SIM_InScanout()) {
+            SIM_PcdInterrupt();
+        } else if (held && now >= hold_until) {
+            // USB_FrameBuffer_Poll() is done with the packet
+            held = 0;
+            if (cdc_mode) {
+                USBD_LL_PrepareReceive(&dev, VGA_OUT_EP, cdc_buffer, VGA_DATA_FS_PACKET_SIZE);
+            } else {
+                USBD_VGA_ReleaseRxBuffer(&dev);
+            }
+        } else {
+            SIM_Advance();
+        }
+    }
+
+    double ms = last_delivery / 1e6;
+    printf("%s, %s: %u of %u packets, %llu bytes in %.2f ms, %.0f KB/s\n",
+           cdc_mode ? "CDC path" : "vendor class", ep.dbl ? "double buffered" : "single buffered",
+           delivered, npackets, (unsigned long long) delivered_bytes, ms,
+           ms > 0 ? delivered_bytes / ms : 0.0);
+    printf("  %u tries NAKed, %.1f%% of the bus time\n", naks, ms > 0 ? nak_ns / (ms * 1e4) : 0.0);
+    if (!cdc_mode) {
+        USBD_VGA_HandleTypeDef *hvga = (USBD_VGA_HandleTypeDef *) dev.pClassData;
+        printf("  %u packets arrived behind a held one, %u standby arms\n", hvga->RxQueued, standbys);
+    }
+    printf("  %u packets wrong or out of order, %u copies outside the given buffer\n", errors, strays);
+    return (errors || strays || delivered != npackets) ? 1 : 0;
+}
@@ -0,0 +1,31 @@
+/*
+ * usbd_conf.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Host stand-in for USB_DEVICE/Target/usbd_conf.h, enough of it for the
+ * device library headers. The USBD_LL_* functions are mocked in bulk_sim.c.
+ */
+
+#ifndef SIM_USBD_CONF_H_
+#define SIM_USBD_CONF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define __IO volatile
+
+#define USBD_MAX_NUM_INTERFACES     1
+#define USBD_MAX_NUM_CONFIGURATION     1
+#define USBD_MAX_STR_DESC_SIZ     512
+#define USBD_DEBUG_LEVEL     0
+#define USBD_SELF_POWERED     1
+#define DEVICE_FS 		0
+
+#define USBD_UsrLog(...)
+#define USBD_ErrLog(...)
+#define USBD_DbgLog(...)
+
+#endif /* SIM_USBD_CONF_H_ */
@@ -27,6 +27,7 @@
 #include "usbd_cdc_if.h"
 
 /* USER CODE BEGIN Includes */
+#include "usbd_vga_if.h"
 
 /* USER CODE END Includes */
 
@@ -64,6 +65,27 @@ USBD_HandleTypeDef hUsbDeviceFS;
 void MX_USB_DEVICE_Init(void)
 {
   /* USER CODE BEGIN USB_DEVICE_Init_PreTreatment */
+#if USBD_VGA_BULK
+  /* Vendor bulk class instead of CDC ACM, with its own descriptors (usbd_desc.c) */
+  if (USBD_Init(&hUsbDeviceFS, &VGA_Desc, DEVICE_FS) != USBD_OK)
+  {
+    Error_Handler();
+  }
+  if (USBD_RegisterClass(&hUsbDeviceFS, &USBD_VGA) != USBD_OK)
+  {
+    Error_Handler();
+  }
+  if (USBD_VGA_RegisterInterface(&hUsbDeviceFS, &USBD_VGA_Interface_fops_FS) != USBD_OK)
+  {
+    Error_Handler();
+  }
+  if (USBD_Start(&hUsbDeviceFS) != USBD_OK)
+  {
+    Error_Handler();
+  }
+#else
+  /* CDC ACM, the generated code below; left out of the vendor build so the
+     CDC class and its buffers are not linked */
 
   /* USER CODE END USB_DEVICE_Init_PreTreatment */
 
@@ -86,6 +108,7 @@ void MX_USB_DEVICE_Init(void)
   }
 
   /* USER CODE BEGIN USB_DEVICE_Init_PostTreatment */
+#endif /* USBD_VGA_BULK */
 
   /* USER CODE END USB_DEVICE_Init_PostTreatment */
 }
@@ -23,6 +23,10 @@
 
 /* USER CODE BEGIN INCLUDE */
 #include "usb_frame_buffer.h"
+#include "usbd_vga.h"
+
+/* The vendor class replaces all of this file, see usbd_vga_if.c */
+#if !USBD_VGA_BULK
 /* USER CODE END INCLUDE */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -128,6 +132,7 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length);
 static int8_t CDC_Receive_FS(uint8_t* pbuf, uint32_t *Len);
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_DECLARATION */
+static void CDC_ArmReceive(void);
 
 /* USER CODE END PRIVATE_FUNCTIONS_DECLARATION */
 
@@ -262,8 +267,11 @@ static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
   /* USER CODE BEGIN 6 */
 	  USB_ProcessReceivedData(Buf, *Len);
 
-  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-  USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  // A packet the ring has no room for yet stays in the buffer and the
+  // endpoint NAKs until USB_FrameBuffer_Poll() is done with it
+  if (!USB_RxHeld()) {
+    CDC_ArmReceive();
+  }
   return (USBD_OK);
   /* USER CODE END 6 */
 }
@@ -295,6 +303,28 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
+/**
+  * @brief  Arm the OUT endpoint for the next packet
+  *         Stream data goes straight into the next ring slot, see USB_RxBuffer()
+  */
+static void CDC_ArmReceive(void)
+{
+  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, USB_RxBuffer(UserRxBufferFS));
+  USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+}
+
+/**
+  * @brief  Take the next packet after one was held, from the main loop
+  *         The USB interrupt is masked so the PCD state is not changed under it
+  */
+void CDC_ResumeReceive(void)
+{
+  HAL_NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn);
+  CDC_ArmReceive();
+  HAL_NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+}
+
+#endif /* !USBD_VGA_BULK */
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
 /**
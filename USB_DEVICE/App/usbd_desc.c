@@ -24,6 +24,7 @@
 #include "usbd_conf.h"
 
 /* USER CODE BEGIN INCLUDE */
+#include "usbd_vga.h"
 
 /* USER CODE END INCLUDE */
 
@@ -71,6 +72,20 @@
 #define USBD_INTERFACE_STRING_FS     "CDC Interface"
 
 /* USER CODE BEGIN PRIVATE_DEFINES */
+#if USBD_VGA_BULK
+/* Vendor bulk class: a product ID and strings of its own, so hosts do not
+ * match it against the CDC ACM driver bound to 22336. 22352 (0x5750) is a
+ * development ID under ST's vendor ID, replace it with an assigned one before
+ * shipping devices. */
+#undef USBD_PID_FS
+#undef USBD_PRODUCT_STRING_FS
+#undef USBD_CONFIGURATION_STRING_FS
+#undef USBD_INTERFACE_STRING_FS
+#define USBD_PID_FS     22352
+#define USBD_PRODUCT_STRING_FS     "STM32 VGA Bulk"
+#define USBD_CONFIGURATION_STRING_FS     "VGA Bulk Config"
+#define USBD_INTERFACE_STRING_FS     "VGA Bulk Interface"
+#endif
 
 /* USER CODE END PRIVATE_DEFINES */
 
@@ -79,6 +94,67 @@
   */
 
 /* USER CODE BEGIN 0 */
+#if USBD_VGA_BULK
+uint8_t * USBD_FS_LangIDStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t * USBD_FS_ManufacturerStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t * USBD_FS_ProductStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t * USBD_FS_SerialStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t * USBD_FS_ConfigStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+uint8_t * USBD_FS_InterfaceStrDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+static uint8_t * USBD_VGA_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length);
+
+/* Device descriptor set used with the vendor class: the class is given per
+ * interface, the strings above are shared with FS_Desc */
+USBD_DescriptorsTypeDef VGA_Desc =
+{
+  USBD_VGA_DeviceDescriptor
+, USBD_FS_LangIDStrDescriptor
+, USBD_FS_ManufacturerStrDescriptor
+, USBD_FS_ProductStrDescriptor
+, USBD_FS_SerialStrDescriptor
+, USBD_FS_ConfigStrDescriptor
+, USBD_FS_InterfaceStrDescriptor
+};
+
+#if defined ( __ICCARM__ ) /* IAR Compiler */
+  #pragma data_alignment=4
+#endif /* defined ( __ICCARM__ ) */
+/** USB standard device descriptor, vendor class. */
+__ALIGN_BEGIN static uint8_t USBD_VGA_DeviceDesc[USB_LEN_DEV_DESC] __ALIGN_END =
+{
+  0x12,                       /*bLength */
+  USB_DESC_TYPE_DEVICE,       /*bDescriptorType*/
+  0x00,                       /*bcdUSB */
+  0x02,
+  0x00,                       /*bDeviceClass: per interface*/
+  0x00,                       /*bDeviceSubClass*/
+  0x00,                       /*bDeviceProtocol*/
+  USB_MAX_EP0_SIZE,           /*bMaxPacketSize*/
+  LOBYTE(USBD_VID),           /*idVendor*/
+  HIBYTE(USBD_VID),           /*idVendor*/
+  LOBYTE(USBD_PID_FS),        /*idProduct*/
+  HIBYTE(USBD_PID_FS),        /*idProduct*/
+  0x00,                       /*bcdDevice rel. 2.00*/
+  0x02,
+  USBD_IDX_MFC_STR,           /*Index of manufacturer  string*/
+  USBD_IDX_PRODUCT_STR,       /*Index of product string*/
+  USBD_IDX_SERIAL_STR,        /*Index of serial number string*/
+  USBD_MAX_NUM_CONFIGURATION  /*bNumConfigurations*/
+};
+
+/**
+  * @brief  Return the vendor class device descriptor
+  * @param  speed : Current device speed
+  * @param  length : Pointer to data length variable
+  * @retval Pointer to descriptor buffer
+  */
+static uint8_t * USBD_VGA_DeviceDescriptor(USBD_SpeedTypeDef speed, uint16_t *length)
+{
+  UNUSED(speed);
+  *length = sizeof(USBD_VGA_DeviceDesc);
+  return USBD_VGA_DeviceDesc;
+}
+#endif
 
 /* USER CODE END 0 */
 
@@ -107,6 +107,8 @@
 extern USBD_DescriptorsTypeDef FS_Desc;
 
 /* USER CODE BEGIN EXPORTED_VARIABLES */
+/** Descriptors of the vendor bulk class, defined with USBD_VGA_BULK */
+extern USBD_DescriptorsTypeDef VGA_Desc;
 
 /* USER CODE END EXPORTED_VARIABLES */
 
@@ -0,0 +1,406 @@
+/*
+ * usbd_vga.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Vendor specific bulk class, see usbd_vga.h
+ *
+ * CDC ACM hands each OUT packet to the application and arms the endpoint
+ * for the next one only after it returns, so every packet is NAKed for as
+ * long as the previous one takes, and at full speed a NAKed OUT costs the
+ * host a whole packet time on the bus. Here the endpoint is armed for the
+ * next buffer before the packet is handed over. A packet the interface
+ * keeps (USBD_BUSY) holds its buffer, the next one waits behind it and
+ * only then is the host held off.
+ *
+ * The double buffered endpoint can take one more packet before the
+ * interrupt for the previous one is serviced, and the HAL copies it to
+ * wherever the transfer pointed, armed or not. So the endpoint only
+ * accepts packets while a buffer beyond the armed one is free. The last
+ * free buffer is given to it in standby, NAKing, for a packet it took
+ * already.
+ *
+ * Only the USBD_LL_* and control request calls of the core are used, so
+ * Tools/usb/bulk_sim.c builds this file against a mocked PCD.
+ */
+
+#include "usbd_vga.h"
+#include "usbd_ctlreq.h"
+
+static uint8_t USBD_VGA_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+static uint8_t USBD_VGA_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx);
+static uint8_t USBD_VGA_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req);
+static uint8_t USBD_VGA_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum);
+static uint8_t USBD_VGA_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum);
+static uint8_t *USBD_VGA_GetFSCfgDesc(uint16_t *length);
+static uint8_t *USBD_VGA_GetDeviceQualifierDesc(uint16_t *length);
+
+/* One device, one instance: no USBD_malloc, whose pool is sized for CDC */
+static USBD_VGA_HandleTypeDef vga_handle;
+
+USBD_ClassTypeDef USBD_VGA =
+{
+  USBD_VGA_Init,
+  USBD_VGA_DeInit,
+  USBD_VGA_Setup,
+  NULL,                 /* EP0_TxSent */
+  NULL,                 /* EP0_RxReady */
+  USBD_VGA_DataIn,
+  USBD_VGA_DataOut,
+  NULL,                 /* SOF */
+  NULL,
+  NULL,
+  USBD_VGA_GetFSCfgDesc, /* full speed only, the F1 has no high speed */
+  USBD_VGA_GetFSCfgDesc,
+  USBD_VGA_GetFSCfgDesc,
+  USBD_VGA_GetDeviceQualifierDesc,
+};
+
+__ALIGN_BEGIN static uint8_t USBD_VGA_CfgFSDesc[USB_VGA_CONFIG_DESC_SIZ] __ALIGN_END =
+{
+  /* Configuration Descriptor */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_CONFIGURATION,          /* bDescriptorType */
+  USB_VGA_CONFIG_DESC_SIZ,              /* wTotalLength */
+  0x00,
+  0x01,                                 /* bNumInterfaces */
+  0x01,                                 /* bConfigurationValue */
+  0x00,                                 /* iConfiguration */
+  0xC0,                                 /* bmAttributes: self powered */
+  0x32,                                 /* MaxPower 100 mA */
+
+  /* Interface Descriptor */
+  0x09,                                 /* bLength */
+  USB_DESC_TYPE_INTERFACE,              /* bDescriptorType */
+  0x00,                                 /* bInterfaceNumber */
+  0x00,                                 /* bAlternateSetting */
+  0x02,                                 /* bNumEndpoints */
+  0xFF,                                 /* bInterfaceClass: vendor specific */
+  0x00,                                 /* bInterfaceSubClass */
+  0x00,                                 /* bInterfaceProtocol */
+  0x00,                                 /* iInterface */
+
+  /* Endpoint OUT Descriptor */
+  0x07,                                 /* bLength */
+  USB_DESC_TYPE_ENDPOINT,               /* bDescriptorType */
+  VGA_OUT_EP,                           /* bEndpointAddress */
+  0x02,                                 /* bmAttributes: Bulk */
+  LOBYTE(VGA_DATA_FS_PACKET_SIZE),      /* wMaxPacketSize */
+  HIBYTE(VGA_DATA_FS_PACKET_SIZE),
+  0x00,                                 /* bInterval */
+
+  /* Endpoint IN Descriptor */
+  0x07,                                 /* bLength */
+  USB_DESC_TYPE_ENDPOINT,               /* bDescriptorType */
+  VGA_IN_EP,                            /* bEndpointAddress */
+  0x02,                                 /* bmAttributes: Bulk */
+  LOBYTE(VGA_DATA_FS_PACKET_SIZE),      /* wMaxPacketSize */
+  HIBYTE(VGA_DATA_FS_PACKET_SIZE),
+  0x00                                  /* bInterval */
+};
+
+__ALIGN_BEGIN static uint8_t USBD_VGA_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
+{
+  USB_LEN_DEV_QUALIFIER_DESC,
+  USB_DESC_TYPE_DEVICE_QUALIFIER,
+  0x00,
+  0x02,
+  0x00,
+  0x00,
+  0x00,
+  0x40,
+  0x01,
+  0x00,
+};
+
+
+/**
+  * @brief  Give the OUT endpoint the buffer after the last packet
+  *         Armed while another buffer is free behind it, else in standby.
+  * @param  pdev: device instance
+  * @param  hvga: class data
+  */
+static void USBD_VGA_Arm(USBD_HandleTypeDef *pdev, USBD_VGA_HandleTypeDef *hvga)
+{
+  uint8_t free = VGA_RX_BUFFERS - hvga->RxCount;
+  uint8_t *buf = hvga->RxBuffer[(hvga->RxTail + hvga->RxCount) % VGA_RX_BUFFERS];
+
+  if (hvga->RxArmed == VGA_RX_ARMED || free == 0U)
+  {
+    return;
+  }
+  if (free >= 2U)
+  {
+    hvga->RxArmed = VGA_RX_ARMED;
+    USBD_LL_PrepareReceive(pdev, VGA_OUT_EP, buf, VGA_DATA_FS_PACKET_SIZE);
+  }
+  else if (hvga->RxArmed == VGA_RX_IDLE)
+  {
+    hvga->RxArmed = VGA_RX_STANDBY;
+    USBD_LL_PrepareStandby(pdev, VGA_OUT_EP, buf, VGA_DATA_FS_PACKET_SIZE);
+  }
+}
+
+/**
+  * @brief  Hand received packets to the interface in order
+  *         Stops at a packet the interface keeps, its buffer stays taken.
+  * @param  pdev: device instance
+  * @param  hvga: class data
+  */
+static void USBD_VGA_Deliver(USBD_HandleTypeDef *pdev, USBD_VGA_HandleTypeDef *hvga)
+{
+  USBD_VGA_ItfTypeDef *fops = (USBD_VGA_ItfTypeDef *)pdev->pUserData;
+
+  while (!hvga->RxHeld && hvga->RxCount != 0U)
+  {
+    uint8_t i = hvga->RxTail;
+
+    if (fops->Receive(hvga->RxBuffer[i], hvga->RxLength[i]) == USBD_BUSY)
+    {
+      hvga->RxHeld = 1U;
+      break;
+    }
+    hvga->RxTail = (i + 1U) % VGA_RX_BUFFERS;
+    hvga->RxCount--;
+    USBD_VGA_Arm(pdev, hvga);
+  }
+}
+
+/**
+  * @brief  Open the endpoints and arm OUT for the first packet
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t USBD_VGA_Init(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  USBD_VGA_HandleTypeDef *hvga = &vga_handle;
+
+  USBD_LL_OpenEP(pdev, VGA_IN_EP, USBD_EP_TYPE_BULK, VGA_DATA_FS_PACKET_SIZE);
+  pdev->ep_in[VGA_IN_EP & 0xFU].is_used = 1U;
+
+  USBD_LL_OpenEP(pdev, VGA_OUT_EP, USBD_EP_TYPE_BULK, VGA_DATA_FS_PACKET_SIZE);
+  pdev->ep_out[VGA_OUT_EP & 0xFU].is_used = 1U;
+
+  hvga->RxTail = 0U;
+  hvga->RxCount = 0U;
+  hvga->RxArmed = VGA_RX_IDLE;
+  hvga->RxHeld = 0U;
+  hvga->TxState = 0U;
+  pdev->pClassData = hvga;
+
+  ((USBD_VGA_ItfTypeDef *)pdev->pUserData)->Init();
+
+  USBD_VGA_Arm(pdev, hvga);
+  return USBD_OK;
+}
+
+/**
+  * @brief  Close the endpoints
+  * @param  pdev: device instance
+  * @param  cfgidx: Configuration index
+  * @retval status
+  */
+static uint8_t USBD_VGA_DeInit(USBD_HandleTypeDef *pdev, uint8_t cfgidx)
+{
+  USBD_LL_CloseEP(pdev, VGA_IN_EP);
+  pdev->ep_in[VGA_IN_EP & 0xFU].is_used = 0U;
+
+  USBD_LL_CloseEP(pdev, VGA_OUT_EP);
+  pdev->ep_out[VGA_OUT_EP & 0xFU].is_used = 0U;
+
+  if (pdev->pClassData != NULL)
+  {
+    ((USBD_VGA_ItfTypeDef *)pdev->pUserData)->DeInit();
+    pdev->pClassData = NULL;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  Standard interface requests, the class defines no others
+  * @param  pdev: device instance
+  * @param  req: usb requests
+  * @retval status
+  */
+static uint8_t USBD_VGA_Setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req)
+{
+  static uint8_t ifalt = 0U;
+  static uint16_t status_info = 0U;
+
+  if ((req->bmRequest & USB_REQ_TYPE_MASK) == USB_REQ_TYPE_STANDARD
+      && pdev->dev_state == USBD_STATE_CONFIGURED)
+  {
+    switch (req->bRequest)
+    {
+      case USB_REQ_GET_STATUS:
+        USBD_CtlSendData(pdev, (uint8_t *)(void *)&status_info, 2U);
+        return USBD_OK;
+
+      case USB_REQ_GET_INTERFACE:
+        USBD_CtlSendData(pdev, &ifalt, 1U);
+        return USBD_OK;
+
+      case USB_REQ_SET_INTERFACE:
+        return USBD_OK;
+
+      default:
+        break;
+    }
+  }
+  USBD_CtlError(pdev, req);
+  return USBD_FAIL;
+}
+
+/**
+  * @brief  IN transfer done, ends it with a ZLP if it filled whole packets
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t USBD_VGA_DataIn(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  USBD_VGA_HandleTypeDef *hvga = (USBD_VGA_HandleTypeDef *)pdev->pClassData;
+
+  if (hvga == NULL)
+  {
+    return USBD_FAIL;
+  }
+  if (pdev->ep_in[epnum].total_length > 0U
+      && (pdev->ep_in[epnum].total_length % VGA_DATA_FS_PACKET_SIZE) == 0U)
+  {
+    pdev->ep_in[epnum].total_length = 0U;
+    USBD_LL_Transmit(pdev, epnum, NULL, 0U);
+  }
+  else
+  {
+    hvga->TxState = 0U;
+  }
+  return USBD_OK;
+}
+
+/**
+  * @brief  OUT packet received
+  *         The endpoint gets the next buffer first, then the packet is
+  *         handed over unless an earlier one is still held.
+  * @param  pdev: device instance
+  * @param  epnum: endpoint number
+  * @retval status
+  */
+static uint8_t USBD_VGA_DataOut(USBD_HandleTypeDef *pdev, uint8_t epnum)
+{
+  USBD_VGA_HandleTypeDef *hvga = (USBD_VGA_HandleTypeDef *)pdev->pClassData;
+
+  if (hvga == NULL)
+  {
+    return USBD_FAIL;
+  }
+  hvga->RxLength[(hvga->RxTail + hvga->RxCount) % VGA_RX_BUFFERS] =
+      (uint16_t)USBD_LL_GetRxDataSize(pdev, epnum);
+  hvga->RxCount++;
+  hvga->RxArmed = VGA_RX_IDLE;
+  hvga->RxPackets++;
+  if (hvga->RxHeld)
+  {
+    hvga->RxQueued++;
+  }
+
+  USBD_VGA_Arm(pdev, hvga);
+  USBD_VGA_Deliver(pdev, hvga);
+  return USBD_OK;
+}
+
+static uint8_t *USBD_VGA_GetFSCfgDesc(uint16_t *length)
+{
+  *length = sizeof(USBD_VGA_CfgFSDesc);
+  return USBD_VGA_CfgFSDesc;
+}
+
+static uint8_t *USBD_VGA_GetDeviceQualifierDesc(uint16_t *length)
+{
+  *length = sizeof(USBD_VGA_DeviceQualifierDesc);
+  return USBD_VGA_DeviceQualifierDesc;
+}
+
+/**
+  * @brief  Link the application side
+  * @param  pdev: device instance
+  * @param  fops: interface callbacks
+  * @retval status
+  */
+uint8_t USBD_VGA_RegisterInterface(USBD_HandleTypeDef *pdev, USBD_VGA_ItfTypeDef *fops)
+{
+  if (fops == NULL)
+  {
+    return USBD_FAIL;
+  }
+  pdev->pUserData = fops;
+  return USBD_OK;
+}
+
+/**
+  * @brief  Set the data for the next USBD_VGA_TransmitPacket()
+  * @param  pdev: device instance
+  * @param  pbuff: Tx Buffer
+  * @param  length: bytes in pbuff
+  * @retval status
+  */
+uint8_t USBD_VGA_SetTxBuffer(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t length)
+{
+  USBD_VGA_HandleTypeDef *hvga = (USBD_VGA_HandleTypeDef *)pdev->pClassData;
+
+  if (hvga == NULL)
+  {
+    return USBD_FAIL;
+  }
+  hvga->TxBuffer = pbuff;
+  hvga->TxLength = length;
+  return USBD_OK;
+}
+
+/**
+  * @brief  Start the IN transfer
+  * @param  pdev: device instance
+  * @retval USBD_BUSY while the previous one is in progress
+  */
+uint8_t USBD_VGA_TransmitPacket(USBD_HandleTypeDef *pdev)
+{
+  USBD_VGA_HandleTypeDef *hvga = (USBD_VGA_HandleTypeDef *)pdev->pClassData;
+
+  if (hvga == NULL)
+  {
+    return USBD_FAIL;
+  }
+  if (hvga->TxState != 0U)
+  {
+    return USBD_BUSY;
+  }
+  hvga->TxState = 1U;
+  pdev->ep_in[VGA_IN_EP & 0xFU].total_length = hvga->TxLength;
+  USBD_LL_Transmit(pdev, VGA_IN_EP, hvga->TxBuffer, (uint16_t)hvga->TxLength);
+  return USBD_OK;
+}
+
+/**
+  * @brief  The interface is done with the packet it kept
+  *         Packets that arrived meanwhile are handed over now, from the
+  *         caller's context. Call with the USB interrupt masked.
+  * @param  pdev: device instance
+  * @retval status
+  */
+uint8_t USBD_VGA_ReleaseRxBuffer(USBD_HandleTypeDef *pdev)
+{
+  USBD_VGA_HandleTypeDef *hvga = (USBD_VGA_HandleTypeDef *)pdev->pClassData;
+
+  if (hvga == NULL || !hvga->RxHeld)
+  {
+    return USBD_FAIL;
+  }
+  hvga->RxHeld = 0U;
+  hvga->RxTail = (hvga->RxTail + 1U) % VGA_RX_BUFFERS;
+  hvga->RxCount--;
+  USBD_VGA_Arm(pdev, hvga);
+  USBD_VGA_Deliver(pdev, hvga);
+  return USBD_OK;
+}
@@ -0,0 +1,87 @@
+/*
+ * usbd_vga.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Vendor specific bulk class for the frame stream. One interface with a
+ * bulk OUT endpoint for host packets and a bulk IN endpoint for the
+ * single byte requests back to the host. The OUT endpoint is double
+ * buffered in packet memory (see usbd_conf.c) and the class keeps
+ * VGA_RX_BUFFERS packet buffers of its own, so the host is not NAKed
+ * while a packet is being processed.
+ */
+
+#ifndef __USBD_VGA_H
+#define __USBD_VGA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "usbd_ioreq.h"
+
+#ifndef USBD_VGA_BULK
+#define USBD_VGA_BULK 0 // 1: enumerate with this class instead of CDC ACM. CDC keeps host
+                        // tools working and receives stream packets in place, see USB_RxBuffer()
+#endif
+
+/** @defgroup usbd_vga_Exported_Defines
+  * @{
+  */
+#define VGA_OUT_EP                                  0x01U  /* EP1, double buffered, OUT only */
+#define VGA_IN_EP                                   0x82U  /* EP2, EP1's second BTABLE slot is taken */
+
+#define VGA_DATA_FS_PACKET_SIZE                     64U
+/* One packet being processed, one being received and one for a packet the
+   double buffered endpoint takes before its interrupt is serviced */
+#define VGA_RX_BUFFERS                              3U
+
+#define USB_VGA_CONFIG_DESC_SIZ                     32U
+/**
+  * @}
+  */
+
+typedef struct _USBD_VGA_Itf
+{
+  int8_t (* Init)(void);
+  int8_t (* DeInit)(void);
+  /* USBD_OK when done with Buf, USBD_BUSY to keep it until USBD_VGA_ReleaseRxBuffer() */
+  int8_t (* Receive)(uint8_t *Buf, uint32_t Len);
+} USBD_VGA_ItfTypeDef;
+
+typedef struct
+{
+  uint8_t  RxBuffer[VGA_RX_BUFFERS][VGA_DATA_FS_PACKET_SIZE];
+  uint16_t RxLength[VGA_RX_BUFFERS];
+  uint8_t  RxTail;                    /* oldest packet the interface is not done with */
+  uint8_t  RxCount;                   /* packets received and not done with */
+  uint8_t  RxArmed;                   /* VGA_RX_* for the buffer after the last packet */
+  uint8_t  RxHeld;                    /* interface kept RxBuffer[RxTail] */
+  uint8_t  *TxBuffer;
+  uint32_t TxLength;
+  __IO uint32_t TxState;
+  uint32_t RxPackets;                 /* packets received */
+  uint32_t RxQueued;                  /* packets that arrived while the previous one was held */
+} USBD_VGA_HandleTypeDef;
+
+#define VGA_RX_IDLE                                 0U  /* no buffer given to the endpoint */
+#define VGA_RX_ARMED                                1U  /* endpoint accepts packets */
+#define VGA_RX_STANDBY                              2U  /* endpoint NAKs, a packet it took already lands in the buffer */
+
+extern USBD_ClassTypeDef USBD_VGA;
+
+uint8_t USBD_VGA_RegisterInterface(USBD_HandleTypeDef *pdev, USBD_VGA_ItfTypeDef *fops);
+uint8_t USBD_VGA_SetTxBuffer(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint16_t length);
+uint8_t USBD_VGA_TransmitPacket(USBD_HandleTypeDef *pdev);
+uint8_t USBD_VGA_ReleaseRxBuffer(USBD_HandleTypeDef *pdev);
+
+/* usbd_conf.c: give an OUT endpoint a buffer and set it to NAK */
+USBD_StatusTypeDef USBD_LL_PrepareStandby(USBD_HandleTypeDef *pdev, uint8_t ep_addr,
+                                          uint8_t *pbuf, uint16_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_VGA_H */
@@ -0,0 +1,80 @@
+/*
+ * usbd_vga_if.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ */
+
+#include "usbd_vga_if.h"
+#include "usb_frame_buffer.h"
+
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+static int8_t VGA_Init_FS(void);
+static int8_t VGA_DeInit_FS(void);
+static int8_t VGA_Receive_FS(uint8_t *Buf, uint32_t Len);
+
+USBD_VGA_ItfTypeDef USBD_VGA_Interface_fops_FS =
+{
+  VGA_Init_FS,
+  VGA_DeInit_FS,
+  VGA_Receive_FS
+};
+
+static int8_t VGA_Init_FS(void)
+{
+  return (USBD_OK);
+}
+
+static int8_t VGA_DeInit_FS(void)
+{
+  return (USBD_OK);
+}
+
+/**
+  * @brief  Packet from the host, in one of the class buffers
+  *         The endpoint is already armed for the other buffer. A packet the
+  *         ring has no room for yet is kept until USB_FrameBuffer_Poll() is
+  *         done with it.
+  * @param  Buf: received packet
+  * @param  Len: bytes in Buf
+  * @retval USBD_BUSY to keep Buf
+  */
+static int8_t VGA_Receive_FS(uint8_t *Buf, uint32_t Len)
+{
+  USB_ProcessReceivedData(Buf, Len);
+  return USB_RxHeld() ? USBD_BUSY : USBD_OK;
+}
+
+/**
+  * @brief  Send bytes to the host on the bulk IN endpoint
+  * @param  Buf: data to send
+  * @param  Len: bytes in Buf
+  * @retval USBD_BUSY while the previous transfer is in progress
+  */
+uint8_t VGA_Transmit_FS(uint8_t *Buf, uint16_t Len)
+{
+  USBD_VGA_HandleTypeDef *hvga = (USBD_VGA_HandleTypeDef *)hUsbDeviceFS.pClassData;
+
+  if (hvga == NULL)
+  {
+    return USBD_FAIL;
+  }
+  if (hvga->TxState != 0U)
+  {
+    return USBD_BUSY;
+  }
+  USBD_VGA_SetTxBuffer(&hUsbDeviceFS, Buf, Len);
+  return USBD_VGA_TransmitPacket(&hUsbDeviceFS);
+}
+
+/**
+  * @brief  Give back the held packet, from the main loop
+  *         The USB interrupt is masked so the class state is not changed under it
+  */
+void VGA_ResumeReceive(void)
+{
+  HAL_NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn);
+  USBD_VGA_ReleaseRxBuffer(&hUsbDeviceFS);
+  HAL_NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+}
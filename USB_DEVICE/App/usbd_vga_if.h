@@ -0,0 +1,21 @@
+/*
+ * usbd_vga_if.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: syn
+ *
+ * Frame buffer side of the vendor bulk class, the counterpart of
+ * usbd_cdc_if.c when USBD_VGA_BULK is set.
+ */
+
+#ifndef __USBD_VGA_IF_H
+#define __USBD_VGA_IF_H
+
+#include "usbd_vga.h"
+
+extern USBD_VGA_ItfTypeDef USBD_VGA_Interface_fops_FS;
+
+uint8_t VGA_Transmit_FS(uint8_t *Buf, uint16_t Len);
+void VGA_ResumeReceive(void);
+
+#endif /* __USBD_VGA_IF_H */
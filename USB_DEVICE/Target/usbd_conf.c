@@ -26,6 +26,7 @@
 #include "usbd_cdc.h"
 
 /* USER CODE BEGIN Includes */
+#include "usbd_vga.h"
 
 /* USER CODE END Includes */
 
@@ -43,6 +44,31 @@ void Error_Handler(void);
 
 /* USER CODE BEGIN 0 */
 
+/**
+  * @brief  Give an OUT endpoint a buffer without accepting more packets
+  *         A packet the double buffered endpoint took before the last one was
+  *         serviced is copied to pbuf, further ones are NAKed until
+  *         USBD_LL_PrepareReceive(). Call from the USB interrupt or with it
+  *         masked.
+  * @param  pdev: Device handle
+  * @param  ep_addr: Endpoint number
+  * @param  pbuf: Pointer to data to be received
+  * @param  size: Data size
+  * @retval USBD status
+  */
+USBD_StatusTypeDef USBD_LL_PrepareStandby(USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint16_t size)
+{
+  PCD_HandleTypeDef *hpcd = (PCD_HandleTypeDef*)pdev->pData;
+  PCD_EPTypeDef *ep = &hpcd->OUT_ep[ep_addr & EP_ADDR_MSK];
+
+  PCD_SET_EP_RX_STATUS(hpcd->Instance, ep->num, USB_EP_RX_NAK);
+  ep->xfer_buff = pbuf;
+  ep->xfer_len = size;
+  ep->xfer_count = 0U;
+
+  return USBD_OK;
+}
+
 /* USER CODE END 0 */
 
 /* USER CODE BEGIN PFP */
@@ -333,9 +359,17 @@ USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef *pdev)
   HAL_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x80 , PCD_SNG_BUF, 0x58);
   /* USER CODE END EndPoint_Configuration */
   /* USER CODE BEGIN EndPoint_Configuration_CDC */
+#if USBD_VGA_BULK
+  /* Vendor class: the host fills one OUT packet buffer while the other is
+     read out. A double buffered endpoint uses both of its BTABLE slots, so
+     IN is on EP2. */
+  HAL_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , VGA_IN_EP , PCD_SNG_BUF, 0xC0);
+  HAL_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , VGA_OUT_EP , PCD_DBL_BUF, 0x100 | (0x140 << 16));
+#else
   HAL_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x81 , PCD_SNG_BUF, 0xC0);
   HAL_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x01 , PCD_SNG_BUF, 0x110);
   HAL_PCDEx_PMAConfig((PCD_HandleTypeDef*)pdev->pData , 0x82 , PCD_SNG_BUF, 0x100);
+#endif
   /* USER CODE END EndPoint_Configuration_CDC */
   return USBD_OK;
 }